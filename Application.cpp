@@ -47,11 +47,35 @@ int main(int argc, char *argv[]) {
 Application::Application(char *infile) {
 	int i;
 	par = new Params();
-	srand (time(NULL));
 	par->setparams(infile);
+	// a single seed for the whole run, so that a run can be repeated
+	unsigned int seed = par->SEED ? par->SEED : time(NULL);
+	srand(seed);
+	cout<<"Random seed: "<<seed<<endl;
 	log = new Log(par);
-	en = new EmulNet(par);
-	en1 = new EmulNet(par);
+	workload = NULL;
+	replay = NULL;
+	replayPending = false;
+	replayed = 0;
+	clientsFinishedAt = -1;
+	if ( par->REPLAY_FILE[0] ) {
+		replay = new ClientTraceReader();
+		if ( replay->open(par->REPLAY_FILE) ) {
+			replayPending = replay->next(replayOp);
+			replayStart = replayOp.time;
+		}
+		else {
+			cout<<"Could not read the client trace "<<par->REPLAY_FILE<<endl;
+		}
+	}
+	else if ( par->WORKLOAD != NO_WORKLOAD ) {
+		workload = new Workload(par, rand());
+	}
+	if ( par->RECORD_FILE[0] && !clientTrace().open(par->RECORD_FILE) ) {
+		cout<<"Could not record the client operations to "<<par->RECORD_FILE<<endl;
+	}
+	en = createTransport(0);
+	en1 = createTransport(1);
 	mp1 = (MP1Node **) malloc(par->EN_GPSZ * sizeof(MP1Node *));
 	mp2 = (MP2Node **) malloc(par->EN_GPSZ * sizeof(MP2Node *));
 
@@ -67,16 +91,49 @@ Application::Application(char *infile) {
 		addressOfMemberNode = (Address *) en->ENinit(addressOfMemberNode, par->PORTNUM);
 		mp1[i] = new MP1Node(memberNode, par, en, log, addressOfMemberNode);
 		mp2[i] = new MP2Node(memberNode, par, en1, log, addressOfMemberNode);
-		log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
-		log->LOG(&(mp2[i]->getMemberNode()->addr), "APP MP2");
+		log->debug(&(mp1[i]->getMemberNode()->addr), "APP");
+		log->debug(&(mp2[i]->getMemberNode()->addr), "APP MP2");
 		delete addressOfMemberNode;
 	}
+	schedule = NULL;
+	if ( par->SCHEDULE_FILE[0] ) {
+		schedule = new FailureSchedule();
+		if ( !schedule->load(par->SCHEDULE_FILE) ) {
+			cout<<"Could not read the failure schedule "<<par->SCHEDULE_FILE<<endl;
+			delete schedule;
+			schedule = NULL;
+		}
+	}
+	bench = NULL;
+	if ( par->BENCH_FILE[0] ) {
+		vector<Address> nodes;
+		for ( i = 0; i < par->EN_GPSZ; i++ ) {
+			nodes.push_back(mp2[i]->getMemberNode()->addr);
+		}
+		bench = new BenchReport();
+		if ( !bench->open(par->BENCH_FILE, par->BENCH_PERIOD, nodes) ) {
+			cout<<"Could not write the benchmark report to "<<par->BENCH_FILE<<endl;
+			delete bench;
+			bench = NULL;
+		}
+	}
+	if ( par->METRICS_PORT && !metrics().startServer(par->METRICS_PORT) ) {
+		cout<<"Could not serve the metrics on port "<<par->METRICS_PORT<<endl;
+	}
+	if ( par->TRACE_FILE[0] ) {
+		SpanTracer::start();
+	}
 }
 
 /**
  * Destructor
  */
 Application::~Application() {
+	metrics().stopServer();
+	delete workload;
+	delete replay;
+	delete schedule;
+	delete bench;
 	delete log;
 	delete en;
 	delete en1;
@@ -100,10 +157,15 @@ int Application::run()
 	int timeWhenAllNodesHaveJoined = 0;
 	// boolean indicating if all nodes have joined
 	bool allNodesJoined = false;
-	srand(time(NULL));
-
-	// As time runs along
-	for( par->globaltime = 0; par->globaltime < TOTAL_RUNNING_TIME; ++par->globaltime ) {
+	clockStart = chrono::steady_clock::now();
+	clockTick = 0;
+
+	// As time runs along, and until the operations of a workload or replay have all been answered,
+	// within the MAX_TIME ticks the network counters are kept for
+	for( par->globaltime = 0; par->globaltime < MAX_TIME &&
+			(par->globaltime < TOTAL_RUNNING_TIME || ((workload || replay) && (clientsFinishedAt < 0 || par->globaltime < clientsFinishedAt + WORKLOAD_DRAIN_TIME))); ++par->globaltime ) {
+		pace();
+		TraceSpan span("tick");
 		// Run the membership protocol
 		mp1Run();
 
@@ -116,8 +178,36 @@ int Application::run()
 			// Call the KV store functionalities
 			mp2Run();
 		}
-		// Fail some nodes
-		//fail();
+		// Wait for the nodes of the other processes before the clients start
+		if ( par->getcurrtime() == INSERT_TIME - 1 && par->GROUP_SIZE > par->EN_GPSZ ) {
+			awaitGroup(par->getcurrtime() > timeWhenAllNodesHaveJoined + 50);
+		}
+		if ( par->METRICS_FILE[0] && par->STATS_PERIOD && par->getcurrtime() % par->STATS_PERIOD == 0 ) {
+			metrics().writeFile(par->METRICS_FILE);
+		}
+		// Fail some nodes, as scheduled
+		if ( schedule != NULL ) {
+			fail();
+		}
+		if ( bench != NULL ) {
+			bench->report(par->getcurrtime(), aliveNodes(), false);
+		}
+	}
+
+	if ( (workload || replay) && clientsFinishedAt < 0 ) {
+		cout<<"Stopped at MAX_TIME = "<<MAX_TIME<<" ticks before every client operation was answered"<<endl;
+	}
+
+	if ( bench != NULL ) {
+		bench->report(par->getcurrtime() - 1, aliveNodes(), true);
+	}
+
+	if ( par->METRICS_FILE[0] ) {
+		metrics().writeFile(par->METRICS_FILE);
+	}
+	clientTrace().close();
+	if ( par->TRACE_FILE[0] && !SpanTracer::dump(par->TRACE_FILE) ) {
+		cout<<"Could not write the trace to "<<par->TRACE_FILE<<endl;
 	}
 
 	// Clean up
@@ -131,6 +221,61 @@ int Application::run()
 	return SUCCESS;
 }
 
+/**
+ * FUNCTION NAME: pace
+ *
+ * DESCRIPTION: With TICK_MS, wait for the wall clock time of the current tick, so that the
+ * 				processes of a deployment go through the ticks at the same rate
+ */
+void Application::pace() {
+	if ( par->TICK_MS ) {
+		this_thread::sleep_until(clockStart + chrono::milliseconds((long)par->TICK_MS * (par->globaltime - clockTick)));
+	}
+}
+
+/**
+ * FUNCTION NAME: groupJoined
+ *
+ * DESCRIPTION: Whether every live node of this process lists the GROUP_SIZE nodes of the deployment
+ */
+bool Application::groupJoined() {
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		Member *member = mp1[i]->getMemberNode();
+		if ( !member->bFailed && (int)member->memberList.size() < par->GROUP_SIZE ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * FUNCTION NAME: awaitGroup
+ *
+ * DESCRIPTION: Start barrier of a deployment spread over several processes, which are not
+ * 				started at the same time. The clock is held at the tick before INSERT_TIME,
+ * 				the protocols running in place every TICK_MS milliseconds (1 at least), until
+ * 				every live node of this process lists the GROUP_SIZE nodes of the deployment
+ * 				and every process got there (see Transport::barrier). The ticks then start
+ * 				again from the wall clock time the barrier was left at, in step with the other
+ * 				processes. Gives up after BARRIER_TIMEOUT_MS.
+ */
+void Application::awaitGroup(bool kvRunning) {
+	chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::milliseconds(BARRIER_TIMEOUT_MS);
+	while ( !(groupJoined() && en->barrier()) ) {
+		if ( chrono::steady_clock::now() >= deadline ) {
+			cout<<"Not all of the GROUP_SIZE = "<<par->GROUP_SIZE<<" nodes joined before INSERT_TIME"<<endl;
+			break;
+		}
+		this_thread::sleep_for(chrono::milliseconds(max(par->TICK_MS, 1)));
+		mp1Run();
+		if ( kvRunning ) {
+			mp2Run();
+		}
+	}
+	clockStart = chrono::steady_clock::now();
+	clockTick = par->getcurrtime();
+}
+
 /**
  * FUNCTION NAME: mp1Run
  *
@@ -138,6 +283,7 @@ int Application::run()
  */
 void Application::mp1Run() {
 	int i;
+	TraceSpan span("Application::mp1Run");
 
 	// For all the nodes in the system
 	for( i = 0; i <= par->EN_GPSZ-1; i++) {
@@ -171,11 +317,9 @@ void Application::mp1Run() {
 		else if( par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
 			// handle messages and send heartbeats
 			mp1[i]->nodeLoop();
-			#ifdef DEBUGLOG
 			if( (i == 0) && (par->globaltime % 500 == 0) ) {
-				log->LOG(&mp1[i]->getMemberNode()->addr, "@@time=%d", par->getcurrtime());
+				log->debug(&mp1[i]->getMemberNode()->addr, "@@time=%d", par->getcurrtime());
 			}
-			#endif
 		}
 
 	}
@@ -191,6 +335,7 @@ void Application::mp1Run() {
  */
 void Application::mp2Run() {
 	int i;
+	TraceSpan span("Application::mp2Run");
 
 	// For all the nodes in the system
 	for( i = 0; i <= par->EN_GPSZ-1; i++) {
@@ -221,14 +366,24 @@ void Application::mp2Run() {
 	/**
 	 * Insert a set of test key value pairs into the system
 	 */
-	if ( par->getcurrtime() == INSERT_TIME ) {
+	if ( par->getcurrtime() == INSERT_TIME && workload == NULL && replay == NULL ) {
 		insertTestKVPairs();
 	}
 
+	/**
+	 * Or drive the configured workload, or replay a client trace, from then on
+	 */
+	if ( par->getcurrtime() >= INSERT_TIME && workload != NULL ) {
+		workloadRun();
+	}
+	else if ( par->getcurrtime() >= INSERT_TIME && replay != NULL ) {
+		replayRun();
+	}
+
 	/**
 	 * Test CRUD operations
 	 */
-	if ( par->getcurrtime() >= TEST_TIME ) {
+	if ( par->getcurrtime() >= TEST_TIME && workload == NULL && replay == NULL ) {
 		/**************
 		 * CREATE TEST
 		 **************/
@@ -324,44 +479,97 @@ void Application::mp2Run() {
 		} // End of update test
 
 	} // end of if ( par->getcurrtime == TEST_TIME)
+
+	/**
+	 * Send the messages batched by the client calls of this tick
+	 */
+	for ( i = 0; i <= par->EN_GPSZ-1; i++ ) {
+		mp2[i]->flushMessages();
+	}
 }
 
 /**
  * FUNCTION NAME: fail
  *
- * DESCRIPTION: This function controls the failure of nodes
- *
- * Note: this is used only by MP1
+ * DESCRIPTION: This function controls the failure of nodes: it applies the events of the
+ * 				failure schedule due at this time (crashes, restarts, network partitions and
+ * 				message drop windows), on both networks
  */
 void Application::fail() {
-	int i, removed;
-
-	// fail half the members at time t=400
-	if( par->DROP_MSG && par->getcurrtime() == 50 ) {
-		par->dropmsg = 1;
+	vector<ScheduleEvent> events;
+	schedule->due(par->getcurrtime(), events);
+
+	for ( size_t e = 0; e < events.size(); e++ ) {
+		ScheduleEvent &event = events[e];
+		switch ( event.action ) {
+			case CRASH_ACTION:
+			case RESTART_ACTION:
+				for ( size_t j = 0; j < event.nodes.size(); j++ ) {
+					int number = event.nodes[j] - 1 - par->NODE_OFFSET;
+					if ( number < 0 || number >= par->EN_GPSZ ) {
+						continue;
+					}
+					Member *member = mp1[number]->getMemberNode();
+					if ( event.action == CRASH_ACTION && !member->bFailed ) {
+						log->debug(&member->addr, "Node failed at time=%d", par->getcurrtime());
+						member->bFailed = true;
+					}
+					else if ( event.action == RESTART_ACTION && member->bFailed ) {
+						log->debug(&member->addr, "Node restarted at time=%d", par->getcurrtime());
+						restart(number);
+					}
+				}
+				break;
+			case PARTITION_ACTION:
+				en->partition(event.nodes);
+				en1->partition(event.nodes);
+				break;
+			case HEAL_ACTION:
+				en->heal();
+				en1->heal();
+				break;
+			case DROP_ACTION:
+				par->MSG_DROP_PROB = event.probability;
+				par->dropmsg = event.probability > 0;
+				break;
+		}
+		if ( bench != NULL ) {
+			bench->event(event.text);
+		}
 	}
+}
 
-	if( par->SINGLE_FAILURE && par->getcurrtime() == 100 ) {
-		removed = (rand() % par->EN_GPSZ);
-		#ifdef DEBUGLOG
-		log->LOG(&mp1[removed]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-		#endif
-		mp1[removed]->getMemberNode()->bFailed = true;
+/**
+ * FUNCTION NAME: restart
+ *
+ * DESCRIPTION: Bring a crashed node back, empty: the messages sent to it while it was down
+ * 				are lost, then it joins the group again
+ */
+void Application::restart(int number) {
+	Member *member = mp1[number]->getMemberNode();
+	en->ENrecv(&member->addr, MP1Node::enqueueWrapper, NULL, 1, &member->mp1q);
+	en1->ENrecv(&member->addr, MP2Node::enqueueWrapper, NULL, 1, &member->mp2q);
+	while ( !member->mp1q.empty() ) {
+		en->ENrelease(member->mp1q.front().elt);
+		member->mp1q.pop();
 	}
-	else if( par->getcurrtime() == 100 ) {
-		removed = rand() % par->EN_GPSZ/2;
-		for ( i = removed; i < removed + par->EN_GPSZ/2; i++ ) {
-			#ifdef DEBUGLOG
-			log->LOG(&mp1[i]->getMemberNode()->addr, "Node failed at time = %d", par->getcurrtime());
-			#endif
-			mp1[i]->getMemberNode()->bFailed = true;
-		}
+	while ( !member->mp2q.empty() ) {
+		en1->ENrelease(member->mp2q.front().elt);
+		member->mp2q.pop();
 	}
+	mp1[number]->nodeStart(JOINADDR, par->PORTNUM);
+	mp2[number]->restart();
+}
 
-	if( par->DROP_MSG && par->getcurrtime() == 300) {
-		par->dropmsg=0;
+/**
+ * FUNCTION NAME: aliveNodes
+ */
+vector<bool> Application::aliveNodes() {
+	vector<bool> alive;
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		alive.push_back(!mp2[i]->getMemberNode()->bFailed);
 	}
-
+	return alive;
 }
 
 /**
@@ -379,6 +587,22 @@ Address Application::getjoinaddr(void){
     return joinaddr;
 }
 
+/**
+ * FUNCTION NAME: createTransport
+ *
+ * DESCRIPTION: Build the network backend selected by the test case.
+ * 				Channel 0 carries the membership protocol, channel 1 the KV store.
+ */
+Transport *Application::createTransport(int channel) {
+	if ( par->TRANSPORT == UDP_TRANSPORT ) {
+		return new UdpNet(par, channel);
+	}
+	if ( par->TRANSPORT == SHM_TRANSPORT ) {
+		return new ShmNet(par, channel);
+	}
+	return new EmulNet(par);
+}
+
 /**
  * FUNCTION NAME: findARandomNodeThatIsAlive
  *
@@ -398,7 +622,6 @@ int Application::findARandomNodeThatIsAlive() {
  * DESCRIPTION: Init NUMBER_OF_INSERTS test KV pairs in the map
  */
 void Application::initTestKVPairs() {
-	srand(time(NULL));
 	int i;
 	string key;
 	key.clear();
@@ -432,13 +655,94 @@ void Application::insertTestKVPairs() {
 		number = findARandomNodeThatIsAlive();
 
 		// Step 2. Issue a create operation
-		log->LOG(&mp2[number]->getMemberNode()->addr, "CREATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
+		log->debug(&mp2[number]->getMemberNode()->addr, "CREATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 		mp2[number]->clientCreate(it->first, it->second);
 	}
 
 	cout<<endl<<"Sent " <<testKVPairs.size() <<" create messages to the ring"<<endl;
 }
 
+/**
+ * FUNCTION NAME: workloadRun
+ *
+ * DESCRIPTION: Issue the workload operations of this tick, each from a random node that is
+ * 				alive. A scan reads its records one by one, a read-modify-write sends its
+ * 				update along with its read as the client API does not wait for replies.
+ */
+void Application::workloadRun() {
+	workload->nextTick(workloadOps);
+	for ( size_t i = 0; i < workloadOps.size(); i++ ) {
+		WorkloadOp &op = workloadOps[i];
+		int number = findARandomNodeThatIsAlive();
+		string key = Workload::keyOf(op.record);
+		switch ( op.type ) {
+			case READ_OP:
+				mp2[number]->clientRead(key);
+				break;
+			case UPDATE_OP:
+				mp2[number]->clientUpdate(key, op.value);
+				break;
+			case INSERT_OP:
+				mp2[number]->clientCreate(key, op.value);
+				break;
+			case SCAN_OP:
+				for ( int j = 0; j < op.length; j++ ) {
+					mp2[number]->clientRead(Workload::keyOf(op.record + j));
+				}
+				break;
+			case RMW_OP:
+				mp2[number]->clientRead(key);
+				mp2[number]->clientUpdate(key, op.value);
+				break;
+		}
+	}
+	if ( workload->finished() && clientsFinishedAt < 0 ) {
+		clientsFinishedAt = par->getcurrtime();
+		cout<<endl;
+		workload->summary(cout);
+	}
+}
+
+/**
+ * FUNCTION NAME: replayRun
+ *
+ * DESCRIPTION: Issue the operations of the replayed client trace due by this tick. The trace
+ * 				starts at INSERT_TIME and runs REPLAY_SPEED times faster than recorded. An
+ * 				operation goes to its recorded coordinator, or to a random node that is alive
+ * 				when that one failed or is not part of this run.
+ */
+void Application::replayRun() {
+	double speed = par->REPLAY_SPEED > 0 ? par->REPLAY_SPEED : 1;
+	while ( replayPending && INSERT_TIME + (int)((replayOp.time - replayStart) / speed) <= par->getcurrtime() ) {
+		int number = replayOp.node - 1 - par->NODE_OFFSET;
+		if ( number < 0 || number >= par->EN_GPSZ || mp2[number]->getMemberNode()->bFailed ) {
+			number = findARandomNodeThatIsAlive();
+		}
+		switch ( replayOp.type ) {
+			case CREATE:
+				mp2[number]->clientCreate(replayOp.key, replayOp.value);
+				break;
+			case READ:
+				mp2[number]->clientRead(replayOp.key);
+				break;
+			case UPDATE:
+				mp2[number]->clientUpdate(replayOp.key, replayOp.value);
+				break;
+			case DELETE:
+				mp2[number]->clientDelete(replayOp.key);
+				break;
+			default:
+				break;
+		}
+		replayed++;
+		replayPending = replay->next(replayOp);
+	}
+	if ( !replayPending && clientsFinishedAt < 0 ) {
+		clientsFinishedAt = par->getcurrtime();
+		cout<<endl<<"Replayed "<<replayed<<" client operations of "<<par->REPLAY_FILE<<endl;
+	}
+}
+
 /**
  * FUNCTION NAME: deleteTest
  *
@@ -458,7 +762,7 @@ void Application::deleteTest() {
 		number = findARandomNodeThatIsAlive();
 
 		// Step 1.b. Issue a delete operation
-		log->LOG(&mp2[number]->getMemberNode()->addr, "DELETE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
+		log->debug(&mp2[number]->getMemberNode()->addr, "DELETE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 		mp2[number]->clientDelete(it->first);
 	}
 
@@ -471,7 +775,7 @@ void Application::deleteTest() {
 	number = findARandomNodeThatIsAlive();
 
 	// Step 2.b. Issue a delete operation
-	log->LOG(&mp2[number]->getMemberNode()->addr, "DELETE OPERATION KEY: %s at time: %d", invalidKey.c_str(), par->getcurrtime());
+	log->debug(&mp2[number]->getMemberNode()->addr, "DELETE OPERATION KEY: %s at time: %d", invalidKey.c_str(), par->getcurrtime());
 	mp2[number]->clientDelete(invalidKey);
 }
 
@@ -500,7 +804,7 @@ void Application::readTest() {
 
 		// Step 1.b Do a read operation
 		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
-		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
+		log->debug(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 		mp2[number]->clientRead(it->first);
 	}
 
@@ -519,7 +823,7 @@ void Application::readTest() {
 		// if less than quorum replicas are found then exit
 		if ( replicas.size() < (RF-1) ) {
 			cout<<endl<<"Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: "<<replicas.size()<<endl;
-			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: %d", replicas.size());
+			log->debug(&mp2[number]->getMemberNode()->addr, "Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: %d", replicas.size());
 			exit(1);
 		}
 
@@ -543,14 +847,14 @@ void Application::readTest() {
 			}
 		}
 		if ( failedOneNode ) {
-			log->LOG(&mp2[nodeToFail]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
+			log->debug(&mp2[nodeToFail]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 			mp2[nodeToFail]->getMemberNode()->bFailed = true;
 			mp1[nodeToFail]->getMemberNode()->bFailed = true;
 			cout<<endl<<"Failed a replica node"<<endl;
 		}
 		else {
 			// The code can never reach here
-			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail a node");
+			log->debug(&mp2[number]->getMemberNode()->addr, "Could not fail a node");
 			cout<<"Could not fail a node. Exiting!!!";
 			exit(1);
 		}
@@ -559,7 +863,7 @@ void Application::readTest() {
 
 		// Step 2.d Issue a read
 		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
-		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
+		log->debug(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 		mp2[number]->clientRead(it->first);
 
 		failedOneNode = false;
@@ -617,7 +921,7 @@ void Application::readTest() {
 			if ( count == 2 ) {
 				for ( int i = 0; i < nodesToFail.size(); i++ ) {
 					// Fail a node
-					log->LOG(&mp2[nodesToFail.at(i)]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
+					log->debug(&mp2[nodesToFail.at(i)]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 					mp2[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
 					mp1[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
 					cout<<endl<<"Failed a replica node"<<endl;
@@ -625,7 +929,7 @@ void Application::readTest() {
 			}
 			else {
 				// The code can never reach here
-				log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail two nodes");
+				log->debug(&mp2[number]->getMemberNode()->addr, "Could not fail two nodes");
 				//cout<<"COUNT: " <<count;
 				cout<<"Could not fail two nodes. Exiting!!!";
 				exit(1);
@@ -635,7 +939,7 @@ void Application::readTest() {
 
 			// Step 3.c Issue a read
 			cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
-			log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
+			log->debug(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 			// This read should fail since at least quorum nodes are not alive
 			mp2[number]->clientRead(it->first);
 		}
@@ -648,7 +952,7 @@ void Application::readTest() {
 			number = findARandomNodeThatIsAlive();
 			// Step 3.e Issue a read
 			cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
-			log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
+			log->debug(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 			// This read should be successful
 			mp2[number]->clientRead(it->first);
 		}
@@ -672,7 +976,7 @@ void Application::readTest() {
 					 mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(SECONDARY).getAddress()->getAddress() &&
 					 mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(TERTIARY).getAddress()->getAddress() ) {
 					// Step 4.c Fail a non-replica node
-					log->LOG(&mp2[i]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
+					log->debug(&mp2[i]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 					mp2[i]->getMemberNode()->bFailed = true;
 					mp1[i]->getMemberNode()->bFailed = true;
 					failedOneNode = true;
@@ -683,7 +987,7 @@ void Application::readTest() {
 		}
 		if ( !failedOneNode ) {
 			// The code can never reach here
-			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail a node(non-replica)");
+			log->debug(&mp2[number]->getMemberNode()->addr, "Could not fail a node(non-replica)");
 			cout<<"Could not fail a node(non-replica). Exiting!!!";
 			exit(1);
 		}
@@ -692,7 +996,7 @@ void Application::readTest() {
 
 		// Step 4.d Issue a read operation
 		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
-		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
+		log->debug(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
 		mp2[number]->clientRead(it->first);
 	}
@@ -710,7 +1014,7 @@ void Application::readTest() {
 
 		// Step 5.b Issue a read operation
 		cout<<endl<<"Reading an invalid key.... ... .. . ."<<endl;
-		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s at time: %d", invalidKey.c_str(), par->getcurrtime());
+		log->debug(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s at time: %d", invalidKey.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
 		mp2[number]->clientRead(invalidKey);
 	}
@@ -745,7 +1049,7 @@ void Application::updateTest() {
 
 		// Step 1.b Do a update operation
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
-		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
+		log->debug(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 		mp2[number]->clientUpdate(it->first, newValue);
 	}
 
@@ -763,7 +1067,7 @@ void Application::updateTest() {
 		replicas = mp2[number]->findNodes(it->first);
 		// if quorum replicas are not found then exit
 		if ( replicas.size() < RF-1 ) {
-			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: %d", replicas.size());
+			log->debug(&mp2[number]->getMemberNode()->addr, "Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: %d", replicas.size());
 			cout<<endl<<"Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: "<<replicas.size()<<endl;
 			exit(1);
 		}
@@ -788,14 +1092,14 @@ void Application::updateTest() {
 			}
 		}
 		if ( failedOneNode ) {
-			log->LOG(&mp2[nodeToFail]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
+			log->debug(&mp2[nodeToFail]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 			mp2[nodeToFail]->getMemberNode()->bFailed = true;
 			mp1[nodeToFail]->getMemberNode()->bFailed = true;
 			cout<<endl<<"Failed a replica node"<<endl;
 		}
 		else {
 			// The code can never reach here
-			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail a node");
+			log->debug(&mp2[number]->getMemberNode()->addr, "Could not fail a node");
 			cout<<"Could not fail a node. Exiting!!!";
 			exit(1);
 		}
@@ -804,7 +1108,7 @@ void Application::updateTest() {
 
 		// Step 2.d Issue a update
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
-		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
+		log->debug(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 		mp2[number]->clientUpdate(it->first, newValue);
 
 		failedOneNode = false;
@@ -860,7 +1164,7 @@ void Application::updateTest() {
 			if ( count == 2 ) {
 				for ( int i = 0; i < nodesToFail.size(); i++ ) {
 					// Fail a node
-					log->LOG(&mp2[nodesToFail.at(i)]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
+					log->debug(&mp2[nodesToFail.at(i)]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 					mp2[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
 					mp1[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
 					cout<<endl<<"Failed a replica node"<<endl;
@@ -868,7 +1172,7 @@ void Application::updateTest() {
 			}
 			else {
 				// The code can never reach here
-				log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail two nodes");
+				log->debug(&mp2[number]->getMemberNode()->addr, "Could not fail two nodes");
 				cout<<"Could not fail two nodes. Exiting!!!";
 				exit(1);
 			}
@@ -877,7 +1181,7 @@ void Application::updateTest() {
 
 			// Step 3.c Issue an update
 			cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
-			log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
+			log->debug(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 			// This update should fail since at least quorum nodes are not alive
 			mp2[number]->clientUpdate(it->first, newValue);
 		}
@@ -890,7 +1194,7 @@ void Application::updateTest() {
 			number = findARandomNodeThatIsAlive();
 			// Step 3.e Issue a update
 			cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
-			log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
+			log->debug(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 			// This update should be successful
 			mp2[number]->clientUpdate(it->first, newValue);
 		}
@@ -914,7 +1218,7 @@ void Application::updateTest() {
 					 mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(SECONDARY).getAddress()->getAddress() &&
 					 mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(TERTIARY).getAddress()->getAddress() ) {
 					// Step 4.c Fail a non-replica node
-					log->LOG(&mp2[i]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
+					log->debug(&mp2[i]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 					mp2[i]->getMemberNode()->bFailed = true;
 					mp1[i]->getMemberNode()->bFailed = true;
 					failedOneNode = true;
@@ -926,7 +1230,7 @@ void Application::updateTest() {
 
 		if ( !failedOneNode ) {
 			// The code can never reach here
-			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail a node(non-replica)");
+			log->debug(&mp2[number]->getMemberNode()->addr, "Could not fail a node(non-replica)");
 			cout<<"Could not fail a node(non-replica). Exiting!!!";
 			exit(1);
 		}
@@ -935,7 +1239,7 @@ void Application::updateTest() {
 
 		// Step 4.d Issue a update operation
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
-		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
+		log->debug(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
 		mp2[number]->clientUpdate(it->first, newValue);
 	}
@@ -954,7 +1258,7 @@ void Application::updateTest() {
 
 		// Step 5.b Issue a read operation
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
-		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", invalidKey.c_str(), invalidValue.c_str(), par->getcurrtime());
+		log->debug(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", invalidKey.c_str(), invalidValue.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
 		mp2[number]->clientUpdate(invalidKey, invalidValue);
 	}
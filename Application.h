@@ -13,10 +13,20 @@
 #include "Params.h"
 #include "Member.h"
 #include "EmulNet.h"
+#include "UdpNet.h"
+#include "ShmNet.h"
 #include "Queue.h"
 #include "MP2Node.h"
 #include "Node.h"
 #include "common.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "Workload.h"
+#include "ClientTrace.h"
+#include "FailureSchedule.h"
+#include "BenchReport.h"
+#include <chrono>
+#include <thread>
 
 /**
  * global variables
@@ -40,6 +50,10 @@ static const char alphanum[] =
 #define RF 3
 #define NUMBER_OF_INSERTS 100
 #define KEY_LENGTH 5
+// ticks the run goes on after the last workload or replayed operation, for its transactions to end
+#define WORKLOAD_DRAIN_TIME 20
+// milliseconds the start barrier waits for the nodes of the other processes of the deployment
+#define BARRIER_TIMEOUT_MS 30000
 
 /**
  * CLASS NAME: Application
@@ -51,27 +65,48 @@ private:
 	// Address for introduction to the group
 	// Coordinator Node
 	char JOINADDR[30];
-	EmulNet *en;
-	EmulNet *en1;
+	Transport *en;
+	Transport *en1;
     Log *log;
 	MP1Node **mp1;
 	MP2Node **mp2;
 	Params *par;
 	map<string, string> testKVPairs;
+	Workload *workload;
+	vector<WorkloadOp> workloadOps;
+	ClientTraceReader *replay;
+	ClientOp replayOp;
+	bool replayPending;
+	int replayStart;
+	long replayed;
+	int clientsFinishedAt;
+	FailureSchedule *schedule;
+	BenchReport *bench;
+	// wall clock start of tick clockTick, the later ticks starting every TICK_MS milliseconds
+	chrono::steady_clock::time_point clockStart;
+	int clockTick;
 public:
 	Application(char *);
 	virtual ~Application();
 	Address getjoinaddr();
+	Transport *createTransport(int channel);
 	void initTestKVPairs();
 	int run();
+	void pace();
+	bool groupJoined();
+	void awaitGroup(bool kvRunning);
 	void mp1Run();
 	void mp2Run();
 	void fail();
+	void restart(int number);
+	vector<bool> aliveNodes();
 	void insertTestKVPairs();
 	int findARandomNodeThatIsAlive();
 	void deleteTest();
 	void readTest();
 	void updateTest();
+	void workloadRun();
+	void replayRun();
 };
 
 #endif /* _APPLICATION_H__ */
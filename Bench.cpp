@@ -0,0 +1,369 @@
+/**********************************
+ * FILE NAME: Bench.cpp
+ *
+ * DESCRIPTION: Microbenchmarks of the storage, codec, routing and network hot paths.
+ * 				Every benchmark reports the time and the heap allocations per operation,
+ * 				the allocations being counted by wrapping malloc at link time (see Makefile).
+ *
+ * 				usage: ./Bench [substring of the benchmarks to run]
+ **********************************/
+
+#include "stdincludes.h"
+#include "HashTable.h"
+#include "Message.h"
+#include "Partitioner.h"
+#include "EmulNet.h"
+#include <chrono>
+#include <new>
+
+/*
+ * Macros
+ */
+// a benchmark doubles its operations until a run takes at least this long
+#define BENCH_MIN_NANOS 200000000L
+// operations between two untimed setup steps
+#define BENCH_CHUNK 1000
+#define BENCH_VALUE_SIZE 32
+#define BENCH_MESSAGE_SIZE 100
+#define BENCH_NET_NODES 10
+
+/*
+ * Allocation counting
+ */
+static unsigned long allocations = 0;
+
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *p, size_t size);
+
+void *__wrap_malloc(size_t size) {
+	allocations++;
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+	allocations++;
+	return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *p, size_t size) {
+	allocations++;
+	return __real_realloc(p, size);
+}
+}
+
+// operator new goes through the wrapped malloc too
+void *operator new(size_t size) {
+	void *p = malloc(size);
+	if ( p == NULL ) {
+		throw bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void *p) noexcept {
+	free(p);
+}
+
+/**
+ * CLASS NAME: Bench
+ *
+ * DESCRIPTION: Timer and allocation counter of a benchmark run. The body of a benchmark
+ * 				does its setup between pause and resume.
+ */
+class Bench {
+private:
+	chrono::steady_clock::time_point started;
+	unsigned long allocationsAtStart;
+public:
+	long nanos;
+	unsigned long allocated;
+	Bench(): nanos(0), allocated(0) {
+		resume();
+	}
+	void pause() {
+		nanos += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - started).count();
+		allocated += allocations - allocationsAtStart;
+	}
+	void resume() {
+		allocationsAtStart = allocations;
+		started = chrono::steady_clock::now();
+	}
+};
+
+static const char *filter = "";
+
+/**
+ * FUNCTION NAME: run
+ *
+ * DESCRIPTION: Run body with 1, 2, 4... operations until it takes BENCH_MIN_NANOS and
+ * 				print the figures of that last run
+ */
+template <class Body> void run(const string &name, Body body) {
+	if ( name.find(filter) == string::npos ) {
+		return;
+	}
+	for ( long n = 1; ; n *= 2 ) {
+		Bench b;
+		body(b, n);
+		b.pause();
+		if ( b.nanos >= BENCH_MIN_NANOS || n >= (1L << 40) ) {
+			printf("%-44s %10ld ops %12.1f ns/op %8.2f allocs/op\n", name.c_str(), n, (double)b.nanos / n, (double)b.allocated / n);
+			fflush(stdout);
+			return;
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: makeKeys
+ */
+static vector<string> makeKeys(int count, const char *prefix) {
+	vector<string> keys;
+	for ( int i = 0; i < count; i++ ) {
+		keys.push_back(prefix + to_string(i));
+	}
+	// visit them out of insertion order
+	random_shuffle(keys.begin(), keys.end());
+	return keys;
+}
+
+/**
+ * FUNCTION NAME: benchHashTable
+ *
+ * DESCRIPTION: create, read, update and deleteKey on a table holding size keys.
+ * 				create adds and deleteKey removes BENCH_CHUNK keys at a time, the table
+ * 				being put back to size keys between the chunks, untimed.
+ */
+static void benchHashTable(int size) {
+	string suffix = "/" + to_string(size);
+	string value(BENCH_VALUE_SIZE, 'v');
+	vector<string> keys = makeKeys(size, "key");
+	vector<string> extra = makeKeys(BENCH_CHUNK, "extra");
+	HashTable ht;
+	for ( int i = 0; i < size; i++ ) {
+		ht.create(keys[i], value);
+	}
+
+	run("HashTable::create" + suffix, [&](Bench &b, long n) {
+		for ( long done = 0; done < n; ) {
+			long chunk = min(n - done, (long)BENCH_CHUNK);
+			for ( long i = 0; i < chunk; i++ ) {
+				ht.create(extra[i], value);
+			}
+			b.pause();
+			for ( long i = 0; i < chunk; i++ ) {
+				ht.deleteKey(extra[i]);
+			}
+			b.resume();
+			done += chunk;
+		}
+	});
+	run("HashTable::read" + suffix, [&](Bench &b, long n) {
+		for ( long i = 0; i < n; i++ ) {
+			ht.read(keys[i % size]);
+		}
+	});
+	run("HashTable::update" + suffix, [&](Bench &b, long n) {
+		for ( long i = 0; i < n; i++ ) {
+			ht.update(keys[i % size], value);
+		}
+	});
+	run("HashTable::deleteKey" + suffix, [&](Bench &b, long n) {
+		for ( long done = 0; done < n; ) {
+			long chunk = min(n - done, min((long)BENCH_CHUNK, (long)size));
+			for ( long i = 0; i < chunk; i++ ) {
+				ht.deleteKey(keys[i]);
+			}
+			b.pause();
+			for ( long i = 0; i < chunk; i++ ) {
+				ht.create(keys[i], value);
+			}
+			b.resume();
+			done += chunk;
+		}
+	});
+}
+
+/**
+ * FUNCTION NAME: benchCodecs
+ *
+ * DESCRIPTION: Message encoding and decoding, Entry parsing
+ */
+static void benchCodecs() {
+	Address from;
+	*(int *)from.addr = 7;
+	*(short *)&from.addr[4] = 0;
+	string key = "key12345";
+	string value(BENCH_VALUE_SIZE, 'v');
+
+	Message create(42, from, MessageType::CREATE, key, value);
+	Message reply(42, from, MessageType::REPLY, true);
+	string createText = create.toString();
+	string replyText = reply.toString();
+	run("Message::toString/create", [&](Bench &b, long n) {
+		for ( long i = 0; i < n; i++ ) {
+			create.toString();
+		}
+	});
+	run("Message::toString/reply", [&](Bench &b, long n) {
+		for ( long i = 0; i < n; i++ ) {
+			reply.toString();
+		}
+	});
+	run("Message(string)/create", [&](Bench &b, long n) {
+		for ( long i = 0; i < n; i++ ) {
+			Message decoded(createText);
+		}
+	});
+	run("Message(string)/reply", [&](Bench &b, long n) {
+		for ( long i = 0; i < n; i++ ) {
+			Message decoded(replyText);
+		}
+	});
+
+	Entry entry(value, 123456, ReplicaType::SECONDARY);
+	string entryText = entry.convertToString();
+	run("Entry::convertToString", [&](Bench &b, long n) {
+		for ( long i = 0; i < n; i++ ) {
+			entry.convertToString();
+		}
+	});
+	run("Entry(string)", [&](Bench &b, long n) {
+		for ( long i = 0; i < n; i++ ) {
+			Entry parsed(entryText);
+		}
+	});
+}
+
+/**
+ * FUNCTION NAME: benchRouting
+ *
+ * DESCRIPTION: What MP2Node::findNodes does on a ring of count nodes, the partition map
+ * 				rebuild of a ring change, and the partitioner lookup behind it
+ */
+static void benchRouting(int count, int type) {
+	vector<Node> ring;
+	for ( int i = 1; i <= count; i++ ) {
+		Address address;
+		*(int *)address.addr = i;
+		*(short *)&address.addr[4] = 0;
+		ring.push_back(Node(address));
+	}
+	sort(ring.begin(), ring.end());
+	Partitioner *partitioner = Partitioner::create(type);
+	partitioner->setNodes(ring);
+	PartitionMap partitionMap;
+	map<int, PartitionMove> moves;
+	partitionMap.update(partitioner, ring, moves);
+
+	string suffix = string("/") + partitioner->name() + "/" + to_string(count);
+	vector<string> keys = makeKeys(BENCH_CHUNK, "key");
+	run("findNodes" + suffix, [&](Bench &b, long n) {
+		for ( long i = 0; i < n; i++ ) {
+			vector<Node> replicas = partitionMap.replicasOf(HashTable::partitionOf(keys[i % BENCH_CHUNK]));
+		}
+	});
+	run("Partitioner::replicasOf" + suffix, [&](Bench &b, long n) {
+		for ( long i = 0; i < n; i++ ) {
+			const string &key = keys[i % BENCH_CHUNK];
+			partitioner->replicasOf(hash64(key.data(), key.size()));
+		}
+	});
+	run("PartitionMap::update" + suffix, [&](Bench &b, long n) {
+		for ( long i = 0; i < n; i++ ) {
+			partitionMap.update(partitioner, ring, moves);
+		}
+	});
+	delete partitioner;
+}
+
+/**
+ * FUNCTION NAME: drop
+ *
+ * DESCRIPTION: Enqueue function of the network benchmarks, throwing the message away
+ */
+static int drop(void *env, char *buff, int size) {
+	(*(long *)env)++;
+	free(buff);
+	return 0;
+}
+
+/**
+ * FUNCTION NAME: benchEmulNet
+ *
+ * DESCRIPTION: ENsend and ENrecv of BENCH_MESSAGE_SIZE byte messages between
+ * 				BENCH_NET_NODES nodes, BENCH_CHUNK messages in flight
+ */
+static void benchEmulNet() {
+	Params *par = new Params();
+	par->EN_GPSZ = BENCH_NET_NODES;
+	par->MAX_MSG_SIZE = 4000;
+	par->dropmsg = 0;
+	par->MSG_DROP_PROB = 0;
+	par->globaltime = 0;
+	// the message counters of msgcount.log make EmulNet too big for the stack
+	EmulNet *en = new EmulNet(par);
+	vector<Address> nodes(BENCH_NET_NODES);
+	for ( int i = 0; i < BENCH_NET_NODES; i++ ) {
+		en->ENinit(&nodes[i], 0);
+	}
+	char data[BENCH_MESSAGE_SIZE];
+	memset(data, 'm', sizeof(data));
+	long received = 0;
+
+	run("EmulNet::ENsend", [&](Bench &b, long n) {
+		for ( long done = 0; done < n; ) {
+			long chunk = min(n - done, (long)BENCH_CHUNK);
+			for ( long i = 0; i < chunk; i++ ) {
+				en->ENsend(&nodes[i % BENCH_NET_NODES], &nodes[(i + 1) % BENCH_NET_NODES], data, sizeof(data));
+			}
+			b.pause();
+			for ( int j = 0; j < BENCH_NET_NODES; j++ ) {
+				en->ENrecv(&nodes[j], drop, NULL, 1, &received);
+			}
+			b.resume();
+			done += chunk;
+		}
+	});
+	run("EmulNet::ENrecv", [&](Bench &b, long n) {
+		for ( long done = 0; done < n; ) {
+			long chunk = min(n - done, (long)BENCH_CHUNK);
+			b.pause();
+			for ( long i = 0; i < chunk; i++ ) {
+				en->ENsend(&nodes[i % BENCH_NET_NODES], &nodes[(i + 1) % BENCH_NET_NODES], data, sizeof(data));
+			}
+			b.resume();
+			for ( int j = 0; j < BENCH_NET_NODES; j++ ) {
+				en->ENrecv(&nodes[j], drop, NULL, 1, &received);
+			}
+			done += chunk;
+		}
+	});
+	delete en;
+	delete par;
+}
+
+/**
+ * FUNCTION NAME: main
+ */
+int main(int argc, char *argv[]) {
+	if ( argc > 1 ) {
+		filter = argv[1];
+	}
+	srand(1);
+	int sizes[] = { 1000, 10000, 100000 };
+	for ( int i = 0; i < 3; i++ ) {
+		benchHashTable(sizes[i]);
+	}
+	benchCodecs();
+	int rings[] = { 10, 100, 1000, 10000 };
+	for ( int type = RING_PARTITIONER; type <= RENDEZVOUS_PARTITIONER; type++ ) {
+		for ( int i = 0; i < 4; i++ ) {
+			benchRouting(rings[i], type);
+		}
+	}
+	benchEmulNet();
+	return SUCCESS;
+}
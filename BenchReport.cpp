@@ -0,0 +1,115 @@
+/**********************************
+ * FILE NAME: BenchReport.cpp
+ *
+ * DESCRIPTION: Definition of the CSV report of a benchmark run
+ **********************************/
+
+#include "BenchReport.h"
+
+/**
+ * Destructor
+ */
+BenchReport::~BenchReport() {
+	if ( file != NULL ) {
+		fclose(file);
+	}
+}
+
+/**
+ * FUNCTION NAME: open
+ *
+ * DESCRIPTION: Create the report and look up the series of the coordinators and of the
+ * 				nodes, which must already be registered
+ *
+ * RETURNS:
+ * true if path could be created
+ */
+bool BenchReport::open(const char *path, int period, vector<Address> &nodes) {
+	file = fopen(path, "w");
+	if ( file == NULL ) {
+		return false;
+	}
+	fputs(BENCH_CSV_HEADER, file);
+	this->period = max(period, 1);
+	const char *types[] = { "create", "read", "update", "delete" };
+	for ( int type = 0; type < 4; type++ ) {
+		string labels = string("role=\"coordinator\",op=\"") + types[type] + "\"";
+		latencies[type] = metrics().histogram("kv_operation_latency_seconds", "Latency of the CRUD operations.", labels);
+		outcomes[type][0] = metrics().counter("kv_operations_total", "CRUD operations by outcome.", labels + ",result=\"fail\"");
+		outcomes[type][1] = metrics().counter("kv_operations_total", "CRUD operations by outcome.", labels + ",result=\"success\"");
+	}
+	for ( size_t i = 0; i < nodes.size(); i++ ) {
+		string labels = "node=\"" + nodes[i].getAddress() + "\"";
+		stabilizationBytes.push_back(metrics().counter("kv_stabilization_bytes_total", "Bytes of the range stream chunks sent, resends included.", labels));
+		keys.push_back(metrics().gauge("kv_store_keys", "Keys held by the node.", labels));
+	}
+	windowTick = 0;
+	started = windowStart = Stats::now();
+	previousOutcomes[0] = previousOutcomes[1] = 0;
+	previousBytes = 0;
+	return true;
+}
+
+/**
+ * FUNCTION NAME: event
+ *
+ * DESCRIPTION: Note an event of the schedule in the current row
+ */
+void BenchReport::event(const string &text) {
+	events += events.empty() ? text : "; " + text;
+}
+
+/**
+ * FUNCTION NAME: report
+ *
+ * DESCRIPTION: Write the row of the period ending at tick once it is over, or at once when
+ * 				it is the last one of the run
+ */
+void BenchReport::report(int tick, const vector<bool> &alive, bool last) {
+	if ( file == NULL || tick <= windowTick || (tick - windowTick < period && !last) ) {
+		return;
+	}
+	unsigned long end = Stats::now();
+	Histogram latency;
+	unsigned long done[2] = { 0, 0 };
+	for ( int type = 0; type < 4; type++ ) {
+		latency.merge(latencies[type]->snapshot());
+		done[0] += outcomes[type][0]->value();
+		done[1] += outcomes[type][1]->value();
+	}
+	Histogram window = latency;
+	window.subtract(previous);
+	previous = latency;
+	unsigned long fail = done[0] - previousOutcomes[0];
+	unsigned long success = done[1] - previousOutcomes[1];
+	previousOutcomes[0] = done[0];
+	previousOutcomes[1] = done[1];
+
+	unsigned long bytes = 0;
+	long stored = 0;
+	int up = 0;
+	for ( size_t i = 0; i < keys.size(); i++ ) {
+		bytes += stabilizationBytes[i]->value();
+		if ( i < alive.size() && alive[i] ) {
+			stored += keys[i]->value();
+			up++;
+		}
+	}
+
+	unsigned long ops = success + fail;
+	int ticks = tick - windowTick;
+	double seconds = max((end - windowStart) / 1e9, 1e-9);
+	char availability[16] = "";
+	if ( ops ) {
+		snprintf(availability, sizeof(availability), "%.4f", (double)success / ops);
+	}
+	fprintf(file, "%d,%.3f,%d,%lu,%.2f,%.0f,%lu,%lu,%s,%.1f,%.1f,%.1f,%lu,%ld,\"%s\"\n",
+			tick, (end - started) / 1e9, up, ops, (double)ops / ticks, ops / seconds, success, fail, availability,
+			window.percentile(50) / 1e3, window.percentile(99) / 1e3, window.percentile(99.9) / 1e3,
+			bytes - previousBytes, stored, events.c_str());
+	fflush(file);
+	previousBytes = bytes;
+	events.clear();
+	windowTick = tick;
+	windowStart = end;
+}
@@ -0,0 +1,55 @@
+/**********************************
+ * FILE NAME: BenchReport.h
+ *
+ * DESCRIPTION: Header file of the CSV report of a benchmark run
+ **********************************/
+
+#ifndef BENCHREPORT_H_
+#define BENCHREPORT_H_
+
+/*
+ * Macros
+ */
+#define BENCH_CSV_HEADER "tick,seconds,alive,ops,ops_per_tick,ops_per_second,success,fail,availability,p50_us,p99_us,p999_us,stabilization_bytes,keys,events\n"
+
+#include "stdincludes.h"
+#include "Member.h"
+#include "Histogram.h"
+#include "Metrics.h"
+#include "Stats.h"
+
+/**
+ * CLASS NAME: BenchReport
+ *
+ * DESCRIPTION: Writes a CSV row every BENCH_PERIOD ticks with what the cluster did since
+ * 				the previous one: the operations its coordinators completed, their throughput
+ * 				per tick and per second, successes, failures and availability (the share of
+ * 				successes), their latency percentiles, the bytes sent by the stabilization
+ * 				protocol, and the events of the failure schedule. The alive nodes and the keys
+ * 				they hold are the ones at the end of the period. Everything is read from the
+ * 				series of the metrics registry, so the report adds nothing to the nodes.
+ */
+class BenchReport {
+private:
+	FILE *file;
+	int period;
+	int windowTick;
+	unsigned long started;
+	unsigned long windowStart;
+	HistogramMetric *latencies[4];
+	Counter *outcomes[4][2];
+	vector<Counter *> stabilizationBytes;
+	vector<Gauge *> keys;
+	Histogram previous;
+	unsigned long previousOutcomes[2];
+	unsigned long previousBytes;
+	string events;
+public:
+	BenchReport(): file(NULL) {}
+	~BenchReport();
+	bool open(const char *path, int period, vector<Address> &nodes);
+	void event(const string &text);
+	void report(int tick, const vector<bool> &alive, bool last);
+};
+
+#endif /* BENCHREPORT_H_ */
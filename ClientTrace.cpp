@@ -0,0 +1,175 @@
+/**********************************
+ * FILE NAME: ClientTrace.cpp
+ *
+ * DESCRIPTION: Definition of the binary traces of the client operations
+ **********************************/
+
+#include "ClientTrace.h"
+
+/**
+ * FUNCTION NAME: clientTrace
+ *
+ * DESCRIPTION: The trace the client APIs of every node record to, when open
+ */
+ClientTraceWriter &clientTrace() {
+	static ClientTraceWriter writer;
+	return writer;
+}
+
+/**
+ * Destructor
+ */
+ClientTraceWriter::~ClientTraceWriter() {
+	close();
+}
+
+/**
+ * FUNCTION NAME: open
+ *
+ * RETURNS:
+ * true if path could be created
+ */
+bool ClientTraceWriter::open(const char *path) {
+	file = fopen(path, "w");
+	if ( file == NULL ) {
+		return false;
+	}
+	buffer.reserve(CLIENT_TRACE_BUFFER * 2);
+	buffer.assign(CLIENT_TRACE_HEADER, CLIENT_TRACE_HEADER_SIZE);
+	lastTime = 0;
+	return true;
+}
+
+/**
+ * FUNCTION NAME: record
+ *
+ * DESCRIPTION: Append an operation, writing out every CLIENT_TRACE_BUFFER bytes
+ */
+void ClientTraceWriter::record(int time, Address *coordinator, MessageType type, const string &key, const string &value) {
+	string out;
+	out.push_back((char)type);
+	putVarint(out, max(time - lastTime, 0));
+	putVarint(out, *(int *)coordinator->addr);
+	putVarint(out, key.size());
+	out += key;
+	if ( type == CREATE || type == UPDATE ) {
+		putVarint(out, value.size());
+		out += value;
+	}
+	lastTime = max(time, lastTime);
+	putVarint(buffer, out.size());
+	buffer += out;
+	if ( buffer.size() >= CLIENT_TRACE_BUFFER ) {
+		fwrite(buffer.data(), 1, buffer.size(), file);
+		buffer.clear();
+	}
+}
+
+/**
+ * FUNCTION NAME: close
+ */
+void ClientTraceWriter::close() {
+	if ( file == NULL ) {
+		return;
+	}
+	fwrite(buffer.data(), 1, buffer.size(), file);
+	buffer.clear();
+	fclose(file);
+	file = NULL;
+}
+
+/**
+ * Destructor
+ */
+ClientTraceReader::~ClientTraceReader() {
+	if ( file != NULL ) {
+		fclose(file);
+	}
+}
+
+/**
+ * FUNCTION NAME: open
+ *
+ * RETURNS:
+ * true if path is a client trace
+ */
+bool ClientTraceReader::open(const char *path) {
+	file = fopen(path, "r");
+	if ( file == NULL ) {
+		return false;
+	}
+	buffer.clear();
+	pos = 0;
+	lastTime = 0;
+	if ( !fill(CLIENT_TRACE_HEADER_SIZE) || buffer.compare(0, CLIENT_TRACE_HEADER_SIZE, CLIENT_TRACE_HEADER, CLIENT_TRACE_HEADER_SIZE) != 0 ) {
+		return false;
+	}
+	pos = CLIENT_TRACE_HEADER_SIZE;
+	return true;
+}
+
+/**
+ * FUNCTION NAME: fill
+ *
+ * DESCRIPTION: Read the file until bytes bytes are buffered from pos on, or it ends
+ *
+ * RETURNS:
+ * whether they are
+ */
+bool ClientTraceReader::fill(int bytes) {
+	if ( pos > 0 ) {
+		buffer.erase(0, pos);
+		pos = 0;
+	}
+	char chunk[CLIENT_TRACE_BUFFER];
+	while ( (int)buffer.size() < bytes ) {
+		size_t n = fread(chunk, 1, sizeof(chunk), file);
+		if ( n == 0 ) {
+			return false;
+		}
+		buffer.append(chunk, n);
+	}
+	return true;
+}
+
+/**
+ * FUNCTION NAME: next
+ *
+ * DESCRIPTION: Read the next operation
+ *
+ * RETURNS:
+ * false at the end of the trace, or at a truncated record
+ */
+bool ClientTraceReader::next(ClientOp &op) {
+	unsigned long length, delta, node, size;
+	// the varint length of a record is at most 10 bytes
+	if ( (int)buffer.size() - pos < 10 ) {
+		fill(10);
+	}
+	if ( !getVarint(buffer.data(), buffer.size(), pos, length) || length == 0 ) {
+		return false;
+	}
+	if ( (int)(buffer.size() - pos) < (long)length && !fill(length) ) {
+		return false;
+	}
+	const char *data = buffer.data();
+	int end = pos + length;
+	op.type = (MessageType)data[pos++];
+	if ( !getVarint(data, end, pos, delta) || !getVarint(data, end, pos, node) || !getVarint(data, end, pos, size) || pos + (long)size > end ) {
+		return false;
+	}
+	op.key.assign(data + pos, size);
+	pos += size;
+	op.value.clear();
+	if ( op.type == CREATE || op.type == UPDATE ) {
+		if ( !getVarint(data, end, pos, size) || pos + (long)size > end ) {
+			return false;
+		}
+		op.value.assign(data + pos, size);
+	}
+	pos = end;
+	lastTime += delta;
+	op.time = lastTime;
+	op.node = node;
+	return true;
+}
@@ -0,0 +1,85 @@
+/**********************************
+ * FILE NAME: ClientTrace.h
+ *
+ * DESCRIPTION: Header file of the binary traces of the client operations, recorded by the
+ * 				client APIs of MP2Node and replayed by the Application layer
+ **********************************/
+
+#ifndef CLIENTTRACE_H_
+#define CLIENTTRACE_H_
+
+/*
+ * Macros
+ */
+// first bytes of a client trace, the last one being the version of the format
+#define CLIENT_TRACE_HEADER "KVOPS\x01"
+#define CLIENT_TRACE_HEADER_SIZE 6
+// bytes buffered between two writes or reads of the file
+#define CLIENT_TRACE_BUFFER 65536
+
+#include "stdincludes.h"
+#include "Member.h"
+#include "common.h"
+#include "Varint.h"
+
+/**
+ * STRUCT NAME: ClientOp
+ *
+ * DESCRIPTION: A client operation: its tick, the id of its coordinator node, its type,
+ * 				key and, for a create or an update, value
+ */
+struct ClientOp {
+	int time;
+	int node;
+	MessageType type;
+	string key;
+	string value;
+};
+
+/**
+ * CLASS NAME: ClientTraceWriter
+ *
+ * DESCRIPTION: Records the client operations to a file.
+ * 				After CLIENT_TRACE_HEADER, a record is its varint length followed by the
+ * 				type byte, the varint ticks since the previous record, the varint id of the
+ * 				coordinator and the varint length and bytes of the key, then of the value
+ * 				for a create or an update.
+ */
+class ClientTraceWriter {
+private:
+	FILE *file;
+	string buffer;
+	int lastTime;
+public:
+	ClientTraceWriter(): file(NULL), lastTime(0) {}
+	~ClientTraceWriter();
+	bool open(const char *path);
+	bool isOpen() {
+		return file != NULL;
+	}
+	void record(int time, Address *coordinator, MessageType type, const string &key, const string &value);
+	void close();
+};
+
+/**
+ * CLASS NAME: ClientTraceReader
+ *
+ * DESCRIPTION: Reads back a trace written by a ClientTraceWriter, a buffer at a time
+ */
+class ClientTraceReader {
+private:
+	FILE *file;
+	string buffer;
+	int pos;
+	int lastTime;
+	bool fill(int bytes);
+public:
+	ClientTraceReader(): file(NULL), pos(0), lastTime(0) {}
+	~ClientTraceReader();
+	bool open(const char *path);
+	bool next(ClientOp &op);
+};
+
+ClientTraceWriter &clientTrace();
+
+#endif /* CLIENTTRACE_H_ */
@@ -0,0 +1,97 @@
+/**********************************
+ * FILE NAME: FailureDetector.cpp
+ *
+ * DESCRIPTION: Definition of the phi accrual failure detector
+ **********************************/
+
+#include "FailureDetector.h"
+
+/**
+ * FUNCTION NAME: add
+ *
+ * DESCRIPTION: Push an inter-arrival time into the window, evicting the oldest one
+ */
+void FailureDetector::add(History &h, double interval) {
+	if ( h.count == PHI_WINDOW ) {
+		double old = h.window[h.next];
+		h.sum -= old;
+		h.sumsq -= old * old;
+	}
+	else {
+		h.count++;
+	}
+	h.window[h.next] = interval;
+	h.sum += interval;
+	h.sumsq += interval * interval;
+	h.next = (h.next + 1) % PHI_WINDOW;
+}
+
+/**
+ * FUNCTION NAME: heartbeat
+ *
+ * DESCRIPTION: Record a fresh heartbeat of a member.
+ * 				The first heartbeat seeds the window around PHI_FIRST_INTERVAL.
+ */
+void FailureDetector::heartbeat(string member, long now) {
+	map<string, History>::iterator search = histories.find(member);
+	if ( search == histories.end() ) {
+		History h;
+		h.count = 0;
+		h.next = 0;
+		h.sum = 0;
+		h.sumsq = 0;
+		h.last = now;
+		add(h, PHI_FIRST_INTERVAL * 0.75);
+		add(h, PHI_FIRST_INTERVAL * 1.25);
+		histories[member] = h;
+		return;
+	}
+	History &h = search->second;
+	if ( now > h.last ) {
+		add(h, now - h.last);
+		h.last = now;
+	}
+}
+
+/**
+ * FUNCTION NAME: phi
+ *
+ * DESCRIPTION: Suspicion level of a member at time now.
+ * 				Uses the logistic approximation of the normal cumulative distribution.
+ *
+ * RETURNS:
+ * phi, 0 for a member that never sent a heartbeat
+ */
+double FailureDetector::phi(string member, long now) {
+	map<string, History>::iterator search = histories.find(member);
+	if ( search == histories.end() ) {
+		return 0;
+	}
+	History &h = search->second;
+	double mean = h.sum / h.count;
+	double variance = h.sumsq / h.count - mean * mean;
+	double std = max(sqrt(max(variance, 0.0)), PHI_MIN_STD);
+
+	double y = (now - h.last - mean) / std;
+	double e = exp(-y * (1.5976 + 0.070566 * y * y));
+	double later;
+	if ( now - h.last > mean ) {
+		later = e / (1.0 + e);
+	}
+	else {
+		later = 1.0 - 1.0 / (1.0 + e);
+	}
+	if ( later < 1e-300 ) {
+		return 300;
+	}
+	return -log10(later);
+}
+
+/**
+ * FUNCTION NAME: remove
+ *
+ * DESCRIPTION: Forget a removed member
+ */
+void FailureDetector::remove(string member) {
+	histories.erase(member);
+}
@@ -0,0 +1,52 @@
+/**********************************
+ * FILE NAME: FailureDetector.h
+ *
+ * DESCRIPTION: Header file of the phi accrual failure detector
+ **********************************/
+
+#ifndef FAILUREDETECTOR_H_
+#define FAILUREDETECTOR_H_
+
+/*
+ * Macros
+ */
+// heartbeat inter-arrival times kept per member
+#define PHI_WINDOW 64
+// inter-arrival time assumed for a member before its first samples come in
+#define PHI_FIRST_INTERVAL 5.0
+// floor of the standard deviation, so a very regular member is not suspected on the first delay
+#define PHI_MIN_STD 2.0
+// suspicion levels from which a member is not gossiped anymore and from which it is removed
+#define PHI_SUSPECT 3.0
+#define PHI_REMOVE 8.0
+
+#include "stdincludes.h"
+
+/**
+ * CLASS NAME: FailureDetector
+ *
+ * DESCRIPTION: Phi accrual failure detector.
+ * 				For every member it keeps the last PHI_WINDOW heartbeat inter-arrival
+ * 				times and turns the time since the last heartbeat into a suspicion level
+ * 				phi = -log10(probability that the heartbeat is still to come), the
+ * 				inter-arrival times being taken as normally distributed.
+ */
+class FailureDetector {
+private:
+	struct History {
+		double window[PHI_WINDOW];
+		int count;
+		int next;
+		double sum;
+		double sumsq;
+		long last;
+	};
+	map<string, History> histories;
+	void add(History &h, double interval);
+public:
+	void heartbeat(string member, long now);
+	double phi(string member, long now);
+	void remove(string member);
+};
+
+#endif /* FAILUREDETECTOR_H_ */
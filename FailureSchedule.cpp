@@ -0,0 +1,94 @@
+/**********************************
+ * FILE NAME: FailureSchedule.cpp
+ *
+ * DESCRIPTION: Definition of the scripted failures of a benchmark run
+ **********************************/
+
+#include "FailureSchedule.h"
+
+/**
+ * FUNCTION NAME: load
+ *
+ * DESCRIPTION: Read the events of a schedule file, sorted by tick
+ *
+ * RETURNS:
+ * false if the file cannot be read or has a line that is not an event, which is reported
+ */
+bool FailureSchedule::load(const char *path) {
+	FILE *fp = fopen(path, "r");
+	if ( fp == NULL ) {
+		return false;
+	}
+	char line[SCHEDULE_LINE_SIZE];
+	int number = 0;
+	bool valid = true;
+	while ( fgets(line, sizeof(line), fp) != NULL ) {
+		number++;
+		char *comment = strchr(line, '#');
+		if ( comment != NULL ) {
+			*comment = 0;
+		}
+		char *time = strtok(line, " \t\r\n");
+		char *action = strtok(NULL, " \t\r\n");
+		if ( time == NULL ) {
+			continue;
+		}
+		ScheduleEvent event;
+		event.time = atoi(time);
+		event.probability = 0;
+		event.text = action == NULL ? "" : action;
+		if ( action == NULL ) {
+			valid = false;
+		}
+		else if ( 0 == strcmp(action, "crash") ) {
+			event.action = CRASH_ACTION;
+		}
+		else if ( 0 == strcmp(action, "restart") ) {
+			event.action = RESTART_ACTION;
+		}
+		else if ( 0 == strcmp(action, "partition") ) {
+			event.action = PARTITION_ACTION;
+		}
+		else if ( 0 == strcmp(action, "heal") ) {
+			event.action = HEAL_ACTION;
+		}
+		else if ( 0 == strcmp(action, "drop") ) {
+			event.action = DROP_ACTION;
+		}
+		else {
+			valid = false;
+		}
+		if ( !valid ) {
+			cout<<path<<":"<<number<<": unknown schedule event"<<endl;
+			break;
+		}
+		for ( char *arg = strtok(NULL, " \t\r\n"); arg != NULL; arg = strtok(NULL, " \t\r\n") ) {
+			event.text += string(" ") + arg;
+			if ( event.action == DROP_ACTION ) {
+				event.probability = atof(arg);
+			}
+			else {
+				event.nodes.push_back(atoi(arg));
+			}
+		}
+		events.push_back(event);
+	}
+	fclose(fp);
+	stable_sort(events.begin(), events.end(), [](const ScheduleEvent &a, const ScheduleEvent &b) {
+		return a.time < b.time;
+	});
+	next = 0;
+	return valid;
+}
+
+/**
+ * FUNCTION NAME: due
+ *
+ * DESCRIPTION: The events of tick time, and the ones of earlier ticks not returned yet
+ */
+void FailureSchedule::due(int time, vector<ScheduleEvent> &out) {
+	out.clear();
+	while ( next < events.size() && events[next].time <= time ) {
+		out.push_back(events[next++]);
+	}
+}
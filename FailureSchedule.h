@@ -0,0 +1,56 @@
+/**********************************
+ * FILE NAME: FailureSchedule.h
+ *
+ * DESCRIPTION: Header file of the scripted failures of a benchmark run
+ **********************************/
+
+#ifndef FAILURESCHEDULE_H_
+#define FAILURESCHEDULE_H_
+
+/*
+ * Macros
+ */
+#define SCHEDULE_LINE_SIZE 1024
+
+#include "stdincludes.h"
+
+enum scheduleACTION { CRASH_ACTION, RESTART_ACTION, PARTITION_ACTION, HEAL_ACTION, DROP_ACTION };
+
+/**
+ * STRUCT NAME: ScheduleEvent
+ *
+ * DESCRIPTION: An action of the schedule, the node ids it applies to or the drop
+ * 				probability it sets, and its line of the schedule for the reports
+ */
+struct ScheduleEvent {
+	int time;
+	scheduleACTION action;
+	vector<int> nodes;
+	double probability;
+	string text;
+};
+
+/**
+ * CLASS NAME: FailureSchedule
+ *
+ * DESCRIPTION: Events read from a schedule file of "tick action arguments" lines, where
+ * 				action is one of
+ * 				- crash id...: the nodes stop, losing their state
+ * 				- restart id...: the nodes come back empty and join the group again
+ * 				- partition id...: the nodes are cut off from the others
+ * 				- heal: the partition ends
+ * 				- drop p: messages are lost with probability p from then on, 0 to stop
+ * 				Node ids are the ones of the addresses, 1 to MAX_NNB. Text after a # is a
+ * 				comment.
+ */
+class FailureSchedule {
+private:
+	vector<ScheduleEvent> events;
+	size_t next;
+public:
+	FailureSchedule(): next(0) {}
+	bool load(const char *path);
+	void due(int time, vector<ScheduleEvent> &out);
+};
+
+#endif /* FAILURESCHEDULE_H_ */
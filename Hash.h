@@ -0,0 +1,129 @@
+/**********************************
+ * FILE NAME: Hash.h
+ *
+ * DESCRIPTION: Seeded 64 bit hash used to place keys and nodes on the ring.
+ * 				It is the wyhash function (final version 4), so every build and every
+ * 				standard library places a key at the same position.
+ **********************************/
+
+#ifndef HASH_H_
+#define HASH_H_
+
+/*
+ * Macros
+ */
+// seed shared by every node of a deployment
+#define HASH_SEED 0x6b7673746f7265ULL
+
+#include "stdincludes.h"
+#include <stdint.h>
+
+static const uint64_t hashSecret[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+
+/**
+ * FUNCTION NAME: hashMum
+ *
+ * DESCRIPTION: 128 bit product of A and B, low half in A and high half in B
+ */
+inline void hashMum(uint64_t *A, uint64_t *B) {
+	__uint128_t r = *A;
+	r *= *B;
+	*A = (uint64_t)r;
+	*B = (uint64_t)(r >> 64);
+}
+
+inline uint64_t hashMix(uint64_t A, uint64_t B) {
+	hashMum(&A, &B);
+	return A ^ B;
+}
+
+inline uint64_t hashRead8(const uint8_t *p) {
+	uint64_t v;
+	memcpy(&v, p, 8);
+	return v;
+}
+
+inline uint64_t hashRead4(const uint8_t *p) {
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+inline uint64_t hashRead3(const uint8_t *p, size_t k) {
+	return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+
+/**
+ * FUNCTION NAME: hash64
+ *
+ * DESCRIPTION: Hash len bytes at data
+ */
+inline uint64_t hash64(const void *data, size_t len, uint64_t seed = HASH_SEED) {
+	const uint8_t *p = (const uint8_t *)data;
+	uint64_t a, b;
+	seed ^= hashMix(seed ^ hashSecret[0], hashSecret[1]);
+	if ( len <= 16 ) {
+		if ( len >= 4 ) {
+			a = (hashRead4(p) << 32) | hashRead4(p + ((len >> 3) << 2));
+			b = (hashRead4(p + len - 4) << 32) | hashRead4(p + len - 4 - ((len >> 3) << 2));
+		}
+		else if ( len > 0 ) {
+			a = hashRead3(p, len);
+			b = 0;
+		}
+		else {
+			a = b = 0;
+		}
+	}
+	else {
+		size_t i = len;
+		if ( i >= 48 ) {
+			uint64_t see1 = seed, see2 = seed;
+			do {
+				seed = hashMix(hashRead8(p) ^ hashSecret[1], hashRead8(p + 8) ^ seed);
+				see1 = hashMix(hashRead8(p + 16) ^ hashSecret[2], hashRead8(p + 24) ^ see1);
+				see2 = hashMix(hashRead8(p + 32) ^ hashSecret[3], hashRead8(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while ( i >= 48 );
+			seed ^= see1 ^ see2;
+		}
+		while ( i > 16 ) {
+			seed = hashMix(hashRead8(p) ^ hashSecret[1], hashRead8(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+		a = hashRead8(p + i - 16);
+		b = hashRead8(p + i - 8);
+	}
+	a ^= hashSecret[1];
+	b ^= seed;
+	hashMum(&a, &b);
+	return hashMix(a ^ hashSecret[0] ^ len, b ^ hashSecret[1]);
+}
+
+/**
+ * FUNCTION NAME: hashBatch
+ *
+ * DESCRIPTION: Hash the keys of n (key, value) records into out.
+ * 				The keys are independent, so four of them are hashed per iteration and
+ * 				the multiplications of one key overlap the loads of the others.
+ */
+inline void hashBatch(const pair<string, string> *records, size_t n, uint64_t *out, uint64_t seed = HASH_SEED) {
+	size_t i = 0;
+	for ( ; i + 4 <= n; i += 4 ) {
+		uint64_t h0 = hash64(records[i].first.data(), records[i].first.size(), seed);
+		uint64_t h1 = hash64(records[i + 1].first.data(), records[i + 1].first.size(), seed);
+		uint64_t h2 = hash64(records[i + 2].first.data(), records[i + 2].first.size(), seed);
+		uint64_t h3 = hash64(records[i + 3].first.data(), records[i + 3].first.size(), seed);
+		out[i] = h0;
+		out[i + 1] = h1;
+		out[i + 2] = h2;
+		out[i + 3] = h3;
+	}
+	for ( ; i < n; i++ ) {
+		out[i] = hash64(records[i].first.data(), records[i].first.size(), seed);
+	}
+}
+
+#endif /* HASH_H_ */
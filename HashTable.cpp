@@ -6,10 +6,49 @@
 
 #include "HashTable.h"
 
-HashTable::HashTable() {}
+HashTable::HashTable(): partitions(PARTITIONS), partitionBytes(PARTITIONS), size(0), byteSize(0) {}
+
+/**
+ * FUNCTION NAME: partitionOf
+ *
+ * DESCRIPTION: Partition of the keyspace the key belongs to
+ */
+int HashTable::partitionOf(const string &key) {
+	return hash64(key.data(), key.size()) % PARTITIONS;
+}
+
+/**
+ * FUNCTION NAME: partition
+ *
+ * DESCRIPTION: Keys of partition p, sorted
+ */
+map<string, string> &HashTable::partition(int p) {
+	return partitions[p];
+}
+
+/**
+ * FUNCTION NAME: bytes
+ *
+ * DESCRIPTION: Bytes of the keys and values of partition p
+ */
+unsigned long HashTable::bytes(int p) {
+	return partitionBytes[p];
+}
 
 HashTable::~HashTable() {}
 
+/**
+ * FUNCTION NAME: dropPartition
+ *
+ * DESCRIPTION: Delete every key of partition p
+ */
+void HashTable::dropPartition(int p) {
+	size -= partitions[p].size();
+	byteSize -= partitionBytes[p];
+	partitions[p].clear();
+	partitionBytes[p] = 0;
+}
+
 /**
  * FUNCTION NAME: create
  *
@@ -20,10 +59,40 @@ HashTable::~HashTable() {}
  * false in FAILURE
  */
 bool HashTable::create(string key, string value) {
-	hashTable.emplace(key, value);
+	int p = partitionOf(key);
+	if ( partitions[p].emplace(key, value).second ) {
+		partitionBytes[p] += key.size() + value.size();
+		byteSize += key.size() + value.size();
+		size++;
+	}
 	return true;
 }
 
+/**
+ * FUNCTION NAME: createBatch
+ *
+ * DESCRIPTION: Insert the records, replacing the values of the keys already there.
+ * 				The keys are hashed to their partitions all at once with hashBatch.
+ */
+void HashTable::createBatch(const vector<pair<string, string> > &records) {
+	vector<uint64_t> hashes(records.size());
+	hashBatch(records.data(), records.size(), hashes.data());
+	for ( size_t i = 0; i < records.size(); i++ ) {
+		int p = hashes[i] % PARTITIONS;
+		pair<map<string, string>::iterator, bool> insert = partitions[p].emplace(records[i].first, records[i].second);
+		if ( insert.second ) {
+			partitionBytes[p] += records[i].first.size() + records[i].second.size();
+			byteSize += records[i].first.size() + records[i].second.size();
+			size++;
+		}
+		else {
+			partitionBytes[p] += records[i].second.size() - insert.first->second.size();
+			byteSize += records[i].second.size() - insert.first->second.size();
+			insert.first->second = records[i].second;
+		}
+	}
+}
+
 /**
  * FUNCTION NAME: read
  *
@@ -35,6 +104,7 @@ bool HashTable::create(string key, string value) {
  */
 string HashTable::read(string key) {
 	map<string, string>::iterator search;
+	map<string, string> &hashTable = partitions[partitionOf(key)];
 
 	search = hashTable.find(key);
 	if ( search != hashTable.end() ) {
@@ -59,14 +129,18 @@ string HashTable::read(string key) {
  */
 bool HashTable::update(string key, string newValue) {
 	map<string, string>::iterator update;
+	int p = partitionOf(key);
+	map<string, string> &hashTable = partitions[p];
 
-	if (read(key).empty()) {
+	update = hashTable.find(key);
+	if ( update == hashTable.end() || update->second.empty() ) {
 		// Key not found
 		return false;
 	}
 	// Key found
-	//update = hashTable.at(key) = newValue;
-	hashTable.at(key) = newValue;
+	partitionBytes[p] += newValue.size() - update->second.size();
+	byteSize += newValue.size() - update->second.size();
+	update->second = newValue;
 	// Update successful
 	return true;
 }
@@ -81,17 +155,18 @@ bool HashTable::update(string key, string newValue) {
  * false on FAILURE
  */
 bool HashTable::deleteKey(string key) {
-	uint eraseCount = 0;
+	int p = partitionOf(key);
+	map<string, string> &hashTable = partitions[p];
+	map<string, string>::iterator search = hashTable.find(key);
 
-	if (read(key).empty()) {
+	if ( search == hashTable.end() || search->second.empty() ) {
 		// Key not found
 		return false;
 	}
-	eraseCount = hashTable.erase(key);
-	if ( eraseCount < 1 ) {
-		// Could not erase
-		return false;
-	}
+	partitionBytes[p] -= search->first.size() + search->second.size();
+	byteSize -= search->first.size() + search->second.size();
+	hashTable.erase(search);
+	size--;
 	// Delete was successful
 	return true;
 }
@@ -106,7 +181,7 @@ bool HashTable::deleteKey(string key) {
  * false otherwise
  */
 bool HashTable::isEmpty() {
-	return hashTable.empty();
+	return size == 0;
 }
 
 /**
@@ -118,7 +193,16 @@ bool HashTable::isEmpty() {
  * size of the table as unit
  */
 unsigned long HashTable::currentSize() {
-	return (unsigned  long)hashTable.size();
+	return size;
+}
+
+/**
+ * FUNCTION NAME: currentBytes
+ *
+ * DESCRIPTION: Returns the bytes of the keys and values of the hash table
+ */
+unsigned long HashTable::currentBytes() {
+	return byteSize;
 }
 
 /**
@@ -127,7 +211,14 @@ unsigned long HashTable::currentSize() {
  * DESCRIPTION: Clear all contents from the hash table
  */
 void HashTable::clear() {
-	hashTable.clear();
+	for ( size_t p = 0; p < partitions.size(); p++ ) {
+		partitions[p].clear();
+		partitionBytes[p] = 0;
+	}
+	size = 0;
+	byteSize = 0;
+	changes.clear();
+	changeOrder.clear();
 }
 
 /**
@@ -139,6 +230,43 @@ void HashTable::clear() {
  * unsigned long count (Should be always 1)
  */
 unsigned long HashTable::count(string key) {
-	return (unsigned long) hashTable.count(key);
+	return (unsigned long) partitions[partitionOf(key)].count(key);
+}
+
+
+/**
+ * FUNCTION NAME: markChanged
+ *
+ * DESCRIPTION: Note that a client wrote or deleted key at tick time, so that older
+ * 				snapshots of it are not applied over the write
+ */
+void HashTable::markChanged(const string &key, int time) {
+	changes[key] = time;
+	changeOrder.push_back(make_pair(time, key));
 }
 
+/**
+ * FUNCTION NAME: changedAt
+ *
+ * RETURNS:
+ * tick of the last client write of key still remembered, -1 if none
+ */
+int HashTable::changedAt(const string &key) {
+	unordered_map<string, int>::iterator search = changes.find(key);
+	return search == changes.end() ? -1 : search->second;
+}
+
+/**
+ * FUNCTION NAME: forgetChanges
+ *
+ * DESCRIPTION: Forget the writes older than tick before
+ */
+void HashTable::forgetChanges(int before) {
+	while ( !changeOrder.empty() && changeOrder.front().first < before ) {
+		unordered_map<string, int>::iterator search = changes.find(changeOrder.front().second);
+		if ( search != changes.end() && search->second == changeOrder.front().first ) {
+			changes.erase(search);
+		}
+		changeOrder.pop_front();
+	}
+}
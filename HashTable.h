@@ -11,28 +11,48 @@
  * Header files
  */
 #include "stdincludes.h"
+#include <unordered_map>
+#include <deque>
 #include "common.h"
 #include "Entry.h"
+#include "Hash.h"
 
 /**
  * CLASS NAME: HashTable
  *
- * DESCRIPTION: This class is a wrapper to the map provided by C++ STL.
- *
+ * DESCRIPTION: This class is a wrapper to the maps provided by C++ STL.
+ * 				Keys are kept in one map per partition of the keyspace, so the keys of a
+ * 				partition can be moved without going through the whole table.
  */
 class HashTable {
+private:
+	vector<map<string, string> > partitions;
+	// bytes of the keys and values of every partition
+	vector<unsigned long> partitionBytes;
+	unsigned long size;
+	unsigned long byteSize;
+	// tick of the last client write of the recently written keys, oldest first
+	unordered_map<string, int> changes;
+	deque<pair<int, string> > changeOrder;
 public:
-	map<string, string> hashTable;
-//public:
 	HashTable();
+	static int partitionOf(const string &key);
+	map<string, string> &partition(int p);
+	unsigned long bytes(int p);
+	void dropPartition(int p);
 	bool create(string key, string value);
+	void createBatch(const vector<pair<string, string> > &records);
 	string read(string key);
 	bool update(string key, string newValue);
 	bool deleteKey(string key);
 	bool isEmpty();
 	unsigned long currentSize();
+	unsigned long currentBytes();
 	void clear();
 	unsigned long count(string key);
+	void markChanged(const string &key, int time);
+	int changedAt(const string &key);
+	void forgetChanges(int before);
 	virtual ~HashTable();
 };
 
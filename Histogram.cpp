@@ -0,0 +1,135 @@
+/**********************************
+ * FILE NAME: Histogram.cpp
+ *
+ * DESCRIPTION: Definition of the HDR-style latency histogram
+ **********************************/
+
+#include "Histogram.h"
+
+/**
+ * constructor
+ */
+Histogram::Histogram(): counts(HIST_BUCKETS, 0) {
+	reset();
+}
+
+/**
+ * FUNCTION NAME: bucketOf
+ *
+ * DESCRIPTION: Bucket of a value: the value itself below 2^HIST_SUB_BITS, otherwise the
+ * 				HIST_SUB_BITS top bits of the value after the bucket of the power of 2 below it
+ */
+int Histogram::bucketOf(unsigned long value) {
+	if ( value < (1UL << HIST_SUB_BITS) ) {
+		return value;
+	}
+	int shift = 63 - __builtin_clzl(value) - HIST_SUB_BITS + 1;
+	return (shift << (HIST_SUB_BITS - 1)) + (value >> shift);
+}
+
+/**
+ * FUNCTION NAME: highestIn
+ *
+ * DESCRIPTION: Highest value counted in a bucket
+ */
+unsigned long Histogram::highestIn(int bucket) {
+	if ( bucket < (1 << HIST_SUB_BITS) ) {
+		return bucket;
+	}
+	int shift = (bucket >> (HIST_SUB_BITS - 1)) - 1;
+	unsigned long sub = bucket - (shift << (HIST_SUB_BITS - 1));
+	return ((sub + 1) << shift) - 1;
+}
+
+/**
+ * FUNCTION NAME: record
+ */
+void Histogram::record(unsigned long value) {
+	value = std::min(value, (1UL << HIST_MAX_BITS) - 1);
+	counts[bucketOf(value)]++;
+	total++;
+	minimum = std::min(minimum, value);
+	maximum = std::max(maximum, value);
+	sum += value;
+}
+
+/**
+ * FUNCTION NAME: merge
+ *
+ * DESCRIPTION: Add the values recorded by another histogram
+ */
+void Histogram::merge(const Histogram &another) {
+	for ( int i = 0; i < HIST_BUCKETS; i++ ) {
+		counts[i] += another.counts[i];
+	}
+	if ( another.total ) {
+		minimum = std::min(minimum, another.minimum);
+		maximum = std::max(maximum, another.maximum);
+	}
+	total += another.total;
+	sum += another.sum;
+}
+
+/**
+ * FUNCTION NAME: subtract
+ *
+ * DESCRIPTION: Remove the values of an earlier snapshot of this histogram, leaving the ones
+ * 				recorded since. The minimum and maximum stay those of all the values.
+ */
+void Histogram::subtract(const Histogram &earlier) {
+	for ( int i = 0; i < HIST_BUCKETS; i++ ) {
+		counts[i] -= earlier.counts[i];
+	}
+	total -= earlier.total;
+	sum -= earlier.sum;
+}
+
+/**
+ * FUNCTION NAME: reset
+ */
+void Histogram::reset() {
+	fill(counts.begin(), counts.end(), 0);
+	total = 0;
+	minimum = ULONG_MAX;
+	maximum = 0;
+	sum = 0;
+}
+
+/**
+ * FUNCTION NAME: percentile
+ *
+ * DESCRIPTION: Value below which p percent of the recorded values fall
+ *
+ * RETURNS:
+ * the highest value of the bucket of that rank, at most the maximum recorded; 0 when empty
+ */
+unsigned long Histogram::percentile(double p) {
+	if ( total == 0 ) {
+		return 0;
+	}
+	unsigned long rank = (unsigned long)ceil(p / 100 * total);
+	rank = std::max(rank, 1UL);
+	unsigned long seen = 0;
+	for ( int i = 0; i < HIST_BUCKETS; i++ ) {
+		seen += counts[i];
+		if ( seen >= rank ) {
+			return std::min(highestIn(i), maximum);
+		}
+	}
+	return maximum;
+}
+
+/**
+ * FUNCTION NAME: countBelow
+ *
+ * DESCRIPTION: Values recorded in the buckets below the one of value, which are exactly the
+ * 				values below it when value is a power of 2
+ */
+unsigned long Histogram::countBelow(unsigned long value) {
+	int last = bucketOf(std::min(value, 1UL << HIST_MAX_BITS));
+	unsigned long below = 0;
+	for ( int i = 0; i < last && i < HIST_BUCKETS; i++ ) {
+		below += counts[i];
+	}
+	return below;
+}
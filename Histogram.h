@@ -0,0 +1,62 @@
+/**********************************
+ * FILE NAME: Histogram.h
+ *
+ * DESCRIPTION: Header file of the HDR-style latency histogram
+ **********************************/
+
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+/*
+ * Macros
+ */
+// every power of 2 is split in 2^(HIST_SUB_BITS-1) buckets, within 1/128 of the value
+#define HIST_SUB_BITS 8
+// values recorded go up to 2^HIST_MAX_BITS - 1, larger ones are counted as the largest
+#define HIST_MAX_BITS 40
+#define HIST_BUCKETS ((HIST_MAX_BITS - HIST_SUB_BITS + 2) << (HIST_SUB_BITS - 1))
+
+#include "stdincludes.h"
+#include <climits>
+
+/**
+ * CLASS NAME: Histogram
+ *
+ * DESCRIPTION: Log-linear histogram with a fixed relative error, as in HdrHistogram.
+ * 				Values below 2^HIST_SUB_BITS have a bucket of their own; above that, the
+ * 				bucket of a value is given by its highest bit and the HIST_SUB_BITS-1 bits
+ * 				following it. Recording is a couple of shifts and an increment, and a
+ * 				percentile is read as the highest value of the bucket it falls in.
+ */
+class Histogram {
+private:
+	vector<unsigned long> counts;
+	unsigned long total;
+	unsigned long minimum;
+	unsigned long maximum;
+	double sum;
+	static int bucketOf(unsigned long value);
+	static unsigned long highestIn(int bucket);
+public:
+	Histogram();
+	void record(unsigned long value);
+	void merge(const Histogram &another);
+	void subtract(const Histogram &earlier);
+	void reset();
+	unsigned long count() {
+		return total;
+	}
+	unsigned long min() {
+		return total ? minimum : 0;
+	}
+	unsigned long max() {
+		return maximum;
+	}
+	double mean() {
+		return total ? sum / total : 0;
+	}
+	unsigned long percentile(double p);
+	unsigned long countBelow(unsigned long value);
+};
+
+#endif /* HISTOGRAM_H_ */
@@ -0,0 +1,485 @@
+/**********************************
+ * FILE NAME: IoLoop.cpp
+ *
+ * DESCRIPTION: Definition of the socket event loops
+ **********************************/
+
+#include "IoLoop.h"
+
+// io_uring user_data tags
+#define URING_RECV (1UL << 32)
+#define URING_SEND (2UL << 32)
+
+/**
+ * FUNCTION NAME: create
+ *
+ * DESCRIPTION: Build the io_uring loop if asked for and supported by the kernel,
+ * 				the epoll loop otherwise
+ */
+IoLoop *IoLoop::create(bool uring, int sockets) {
+	if ( uring ) {
+		UringLoop *loop = new UringLoop(sockets);
+		if ( loop->init() ) {
+			return loop;
+		}
+		delete loop;
+	}
+	return new EpollLoop();
+}
+
+/**
+ * Constructor
+ */
+EpollLoop::EpollLoop() {
+	epfd = epoll_create1(0);
+}
+
+/**
+ * Destructor
+ */
+EpollLoop::~EpollLoop() {
+	close(epfd);
+}
+
+/**
+ * FUNCTION NAME: addSocket
+ *
+ * DESCRIPTION: Watch a socket for incoming datagrams
+ */
+bool EpollLoop::addSocket(int fd) {
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.fd = fd;
+	return epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+/**
+ * FUNCTION NAME: send
+ *
+ * DESCRIPTION: Queue a datagram, the queue of a socket is flushed when it reaches IO_BATCH
+ */
+void EpollLoop::send(int fd, struct sockaddr_in *to, char *data, int size) {
+	vector<Datagram> &queue = pending[fd];
+	queue.emplace_back();
+	queue.back().to = *to;
+	queue.back().data.assign(data, size);
+	if ( queue.size() >= IO_BATCH ) {
+		flush(fd);
+	}
+}
+
+/**
+ * FUNCTION NAME: flush
+ *
+ * DESCRIPTION: Hand the queued datagrams of one socket to the kernel with sendmmsg.
+ * 				Datagrams the kernel does not accept right now stay queued.
+ */
+void EpollLoop::flush(int fd) {
+	vector<Datagram> &queue = pending[fd];
+	struct mmsghdr msgs[IO_BATCH];
+	struct iovec iovs[IO_BATCH];
+	size_t sent = 0;
+
+	while ( sent < queue.size() ) {
+		int n = min((int)(queue.size() - sent), IO_BATCH);
+		for ( int i = 0; i < n; i++ ) {
+			Datagram &dg = queue[sent + i];
+			iovs[i].iov_base = (void *)dg.data.data();
+			iovs[i].iov_len = dg.data.size();
+			memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+			msgs[i].msg_hdr.msg_name = &dg.to;
+			msgs[i].msg_hdr.msg_namelen = sizeof(dg.to);
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+		int ret = sendmmsg(fd, msgs, n, MSG_DONTWAIT);
+		if ( ret <= 0 ) {
+			if ( ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK ) {
+				// Unreachable peer or similar: the datagram is lost, like on a real network
+				sent++;
+				continue;
+			}
+			break;
+		}
+		sent += ret;
+	}
+	queue.erase(queue.begin(), queue.begin() + sent);
+}
+
+/**
+ * FUNCTION NAME: flush
+ *
+ * DESCRIPTION: Flush the queues of every socket
+ */
+void EpollLoop::flush() {
+	for ( map<int, vector<Datagram> >::iterator it = pending.begin(); it != pending.end(); it++ ) {
+		if ( !it->second.empty() ) {
+			flush(it->first);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: poll
+ *
+ * DESCRIPTION: Flush the sends and collect the readable sockets without blocking
+ */
+void EpollLoop::poll() {
+	struct epoll_event events[IO_BATCH];
+	int n;
+
+	flush();
+	do {
+		n = epoll_wait(epfd, events, IO_BATCH, 0);
+		for ( int i = 0; i < n; i++ ) {
+			readable.insert(events[i].data.fd);
+		}
+	} while ( n == IO_BATCH );
+}
+
+/**
+ * FUNCTION NAME: recv
+ *
+ * DESCRIPTION: Drain a readable socket with recvmmsg and enqueue a copy of every datagram
+ *
+ * RETURNS:
+ * number of datagrams delivered
+ */
+int EpollLoop::recv(int fd, int (* enq)(void *, char *, int), void *queue) {
+	struct mmsghdr msgs[IO_BATCH];
+	struct iovec iovs[IO_BATCH];
+	int delivered = 0;
+
+	if ( readable.erase(fd) == 0 ) {
+		return 0;
+	}
+
+	while ( true ) {
+		for ( int i = 0; i < IO_BATCH; i++ ) {
+			iovs[i].iov_base = recvbuff[i];
+			iovs[i].iov_len = IO_BUFFSIZE;
+			memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+		int n = recvmmsg(fd, msgs, IO_BATCH, MSG_DONTWAIT, NULL);
+		if ( n <= 0 ) {
+			break;
+		}
+		for ( int i = 0; i < n; i++ ) {
+			int sz = msgs[i].msg_len;
+			char *tmp = (char *) malloc(sz * sizeof(char));
+			memcpy(tmp, recvbuff[i], sz);
+			(*enq)(queue, tmp, sz);
+		}
+		delivered += n;
+		if ( n < IO_BATCH ) {
+			break;
+		}
+	}
+	return delivered;
+}
+
+/**
+ * Constructor
+ */
+UringLoop::UringLoop(int sockets): ringfd(-1), sqes(NULL), sqring(MAP_FAILED), cqring(MAP_FAILED), queued(0), recvbuffs(NULL), sendslots(NULL) {
+	nrecvbuffs = sockets * URING_READS_PER_SOCKET;
+	recvfd.resize(nrecvbuffs);
+}
+
+/**
+ * Destructor
+ */
+UringLoop::~UringLoop() {
+	if ( sqes != NULL ) {
+		munmap(sqes, sqessize);
+	}
+	if ( cqring != MAP_FAILED && cqring != sqring ) {
+		munmap(cqring, cqringsize);
+	}
+	if ( sqring != MAP_FAILED ) {
+		munmap(sqring, sqringsize);
+	}
+	if ( ringfd >= 0 ) {
+		close(ringfd);
+	}
+	free(recvbuffs);
+	free(sendslots);
+}
+
+/**
+ * FUNCTION NAME: init
+ *
+ * DESCRIPTION: Set up the rings and register the receive buffers
+ *
+ * RETURNS:
+ * false if io_uring is not available
+ */
+bool UringLoop::init() {
+	struct io_uring_params p;
+	memset(&p, 0, sizeof(p));
+	ringfd = syscall(__NR_io_uring_setup, URING_ENTRIES, &p);
+	if ( ringfd < 0 ) {
+		return false;
+	}
+
+	sqringsize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	cqringsize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if ( p.features & IORING_FEAT_SINGLE_MMAP ) {
+		sqringsize = max(sqringsize, cqringsize);
+	}
+	sqring = mmap(NULL, sqringsize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringfd, IORING_OFF_SQ_RING);
+	if ( sqring == MAP_FAILED ) {
+		return false;
+	}
+	if ( p.features & IORING_FEAT_SINGLE_MMAP ) {
+		cqring = sqring;
+	}
+	else {
+		cqring = mmap(NULL, cqringsize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringfd, IORING_OFF_CQ_RING);
+		if ( cqring == MAP_FAILED ) {
+			return false;
+		}
+	}
+	sqessize = p.sq_entries * sizeof(struct io_uring_sqe);
+	void *ptr = mmap(NULL, sqessize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringfd, IORING_OFF_SQES);
+	if ( ptr == MAP_FAILED ) {
+		return false;
+	}
+	sqes = (struct io_uring_sqe *)ptr;
+
+	sqhead = (unsigned *)((char *)sqring + p.sq_off.head);
+	sqtail = (unsigned *)((char *)sqring + p.sq_off.tail);
+	sqmask = (unsigned *)((char *)sqring + p.sq_off.ring_mask);
+	sqarray = (unsigned *)((char *)sqring + p.sq_off.array);
+	cqhead = (unsigned *)((char *)cqring + p.cq_off.head);
+	cqtail = (unsigned *)((char *)cqring + p.cq_off.tail);
+	cqmask = (unsigned *)((char *)cqring + p.cq_off.ring_mask);
+	cqes = (struct io_uring_cqe *)((char *)cqring + p.cq_off.cqes);
+	sqentries = p.sq_entries;
+
+	recvbuffs = (char *)malloc((size_t)nrecvbuffs * URING_BUFFSIZE);
+	sendslots = (SendSlot *)malloc(URING_SEND_SLOTS * sizeof(SendSlot));
+	if ( recvbuffs == NULL || sendslots == NULL ) {
+		return false;
+	}
+	struct iovec region;
+	region.iov_base = recvbuffs;
+	region.iov_len = (size_t)nrecvbuffs * URING_BUFFSIZE;
+	if ( syscall(__NR_io_uring_register, ringfd, IORING_REGISTER_BUFFERS, &region, 1) < 0 ) {
+		return false;
+	}
+	for ( int i = nrecvbuffs - 1; i >= 0; i-- ) {
+		freerecv.push_back(i);
+	}
+	for ( int i = URING_SEND_SLOTS - 1; i >= 0; i-- ) {
+		freesend.push_back(i);
+	}
+	return true;
+}
+
+/**
+ * FUNCTION NAME: enter
+ *
+ * DESCRIPTION: Submit queued entries and wait for at least wait completions
+ */
+int UringLoop::enter(unsigned submit, unsigned wait) {
+	int ret;
+	do {
+		ret = syscall(__NR_io_uring_enter, ringfd, submit, wait, IORING_ENTER_GETEVENTS, NULL, 0);
+	} while ( ret < 0 && errno == EINTR );
+	return ret;
+}
+
+/**
+ * FUNCTION NAME: getSqe
+ *
+ * DESCRIPTION: Next free submission entry, submitting the queued ones if the ring is full
+ */
+struct io_uring_sqe *UringLoop::getSqe() {
+	unsigned tail = *sqtail;
+	unsigned head = __atomic_load_n(sqhead, __ATOMIC_ACQUIRE);
+	if ( tail - head >= sqentries ) {
+		flush();
+		head = __atomic_load_n(sqhead, __ATOMIC_ACQUIRE);
+	}
+	unsigned index = tail & *sqmask;
+	struct io_uring_sqe *sqe = &sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	sqarray[index] = index;
+	__atomic_store_n(sqtail, tail + 1, __ATOMIC_RELEASE);
+	queued++;
+	return sqe;
+}
+
+/**
+ * FUNCTION NAME: armRead
+ *
+ * DESCRIPTION: Arm one read of a datagram into a registered buffer
+ */
+void UringLoop::armRead(int fd) {
+	if ( freerecv.empty() ) {
+		return;
+	}
+	int buf = freerecv.back();
+	freerecv.pop_back();
+	recvfd[buf] = fd;
+
+	struct io_uring_sqe *sqe = getSqe();
+	sqe->opcode = IORING_OP_READ_FIXED;
+	sqe->fd = fd;
+	sqe->addr = (unsigned long)(recvbuffs + (size_t)buf * URING_BUFFSIZE);
+	sqe->len = URING_BUFFSIZE;
+	sqe->buf_index = 0;
+	sqe->user_data = URING_RECV | buf;
+}
+
+/**
+ * FUNCTION NAME: addSocket
+ *
+ * DESCRIPTION: Arm the reads of a new socket
+ */
+bool UringLoop::addSocket(int fd) {
+	// Reads wait inside io_uring, only the sends ask for MSG_DONTWAIT
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+	for ( int i = 0; i < URING_READS_PER_SOCKET; i++ ) {
+		armRead(fd);
+	}
+	return true;
+}
+
+/**
+ * FUNCTION NAME: send
+ *
+ * DESCRIPTION: Copy the datagram into a send slot and queue a SENDMSG entry for it
+ */
+void UringLoop::send(int fd, struct sockaddr_in *to, char *data, int size) {
+	if ( size > IO_BUFFSIZE ) {
+		return;
+	}
+	while ( freesend.empty() ) {
+		// Every slot is in flight: wait for some sends to complete
+		enter(queued, 1);
+		queued = 0;
+		reap();
+	}
+	int slot = freesend.back();
+	freesend.pop_back();
+
+	SendSlot *s = &sendslots[slot];
+	s->to = *to;
+	memcpy(s->data, data, size);
+	s->iov.iov_base = s->data;
+	s->iov.iov_len = size;
+	memset(&s->hdr, 0, sizeof(s->hdr));
+	s->hdr.msg_name = &s->to;
+	s->hdr.msg_namelen = sizeof(s->to);
+	s->hdr.msg_iov = &s->iov;
+	s->hdr.msg_iovlen = 1;
+
+	struct io_uring_sqe *sqe = getSqe();
+	sqe->opcode = IORING_OP_SENDMSG;
+	sqe->fd = fd;
+	sqe->addr = (unsigned long)&s->hdr;
+	sqe->len = 1;
+	sqe->msg_flags = MSG_DONTWAIT;
+	sqe->user_data = URING_SEND | slot;
+}
+
+/**
+ * FUNCTION NAME: flush
+ *
+ * DESCRIPTION: Submit every queued entry with one system call
+ */
+void UringLoop::flush() {
+	if ( queued > 0 ) {
+		enter(queued, 0);
+		queued = 0;
+	}
+}
+
+/**
+ * FUNCTION NAME: reap
+ *
+ * DESCRIPTION: Consume the completion ring. Finished reads are parked per socket
+ * 				until recv, finished sends give their slot back.
+ */
+void UringLoop::reap() {
+	unsigned head = *cqhead;
+	unsigned tail = __atomic_load_n(cqtail, __ATOMIC_ACQUIRE);
+
+	while ( head != tail ) {
+		struct io_uring_cqe *cqe = &cqes[head & *cqmask];
+		unsigned long tag = cqe->user_data & ~0xffffffffUL;
+		int index = (int)(cqe->user_data & 0xffffffffUL);
+		if ( tag == URING_RECV ) {
+			int fd = recvfd[index];
+			if ( cqe->res > 0 ) {
+				ready[fd].push_back(make_pair(index, cqe->res));
+			}
+			else {
+				freerecv.push_back(index);
+				if ( cqe->res != -EBADF && cqe->res != -ECANCELED ) {
+					armRead(fd);
+				}
+			}
+		}
+		else if ( tag == URING_SEND ) {
+			freesend.push_back(index);
+		}
+		head++;
+	}
+	__atomic_store_n(cqhead, head, __ATOMIC_RELEASE);
+}
+
+/**
+ * FUNCTION NAME: poll
+ *
+ * DESCRIPTION: Submit the queued sends and re-armed reads and collect the completions
+ */
+void UringLoop::poll() {
+	enter(queued, 0);
+	queued = 0;
+	reap();
+}
+
+/**
+ * FUNCTION NAME: recv
+ *
+ * DESCRIPTION: Enqueue a copy of every datagram read on a socket and re-arm the reads.
+ * 				While every armed read of the socket completes the socket may hold more,
+ * 				so the re-armed reads are submitted again until one of them stays pending.
+ *
+ * RETURNS:
+ * number of datagrams delivered
+ */
+int UringLoop::recv(int fd, int (* enq)(void *, char *, int), void *queue) {
+	int delivered = 0;
+
+	while ( true ) {
+		map<int, vector<pair<int, int> > >::iterator search = ready.find(fd);
+		if ( search == ready.end() ) {
+			break;
+		}
+		vector<pair<int, int> > done;
+		done.swap(search->second);
+		ready.erase(search);
+
+		for ( size_t i = 0; i < done.size(); i++ ) {
+			int sz = done[i].second;
+			char *tmp = (char *) malloc(sz * sizeof(char));
+			memcpy(tmp, recvbuffs + (size_t)done[i].first * URING_BUFFSIZE, sz);
+			(*enq)(queue, tmp, sz);
+			freerecv.push_back(done[i].first);
+			armRead(fd);
+		}
+		delivered += done.size();
+		if ( done.size() < URING_READS_PER_SOCKET ) {
+			break;
+		}
+		poll();
+	}
+	return delivered;
+}
@@ -0,0 +1,128 @@
+/**********************************
+ * FILE NAME: IoLoop.h
+ *
+ * DESCRIPTION: Header file of the socket event loops used by the real network backends
+ **********************************/
+
+#ifndef _IOLOOP_H_
+#define _IOLOOP_H_
+
+/*
+ * Macros
+ */
+// number of datagrams moved per sendmmsg/recvmmsg call
+#define IO_BATCH 64
+#define IO_BUFFSIZE 8192
+// io_uring geometry: reads kept armed per socket and size of their registered buffers, send slots
+#define URING_ENTRIES 1024
+#define URING_READS_PER_SOCKET 16
+#define URING_BUFFSIZE 4096
+#define URING_SEND_SLOTS 1024
+
+#include "stdincludes.h"
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <errno.h>
+#include <set>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+/**
+ * CLASS NAME: IoLoop
+ *
+ * DESCRIPTION: Batches datagram sends and receives of many sockets.
+ * 				Sends are queued and handed to the kernel on flush, poll gathers what
+ * 				arrived on every socket and recv delivers what arrived on one of them.
+ */
+class IoLoop {
+public:
+	virtual ~IoLoop() {}
+	virtual bool addSocket(int fd) = 0;
+	virtual void send(int fd, struct sockaddr_in *to, char *data, int size) = 0;
+	virtual void flush() = 0;
+	virtual void poll() = 0;
+	virtual int recv(int fd, int (* enq)(void *, char *, int), void *queue) = 0;
+	virtual const char *name() = 0;
+	static IoLoop *create(bool uring, int sockets);
+};
+
+/**
+ * CLASS NAME: EpollLoop
+ *
+ * DESCRIPTION: One epoll_wait per poll finds the readable sockets, which are then
+ * 				drained with recvmmsg. Sends go out with sendmmsg, IO_BATCH at a time.
+ */
+class EpollLoop : public IoLoop {
+private:
+	struct Datagram {
+		struct sockaddr_in to;
+		string data;
+	};
+	int epfd;
+	map<int, vector<Datagram> > pending;
+	set<int> readable;
+	char recvbuff[IO_BATCH][IO_BUFFSIZE];
+	void flush(int fd);
+public:
+	EpollLoop();
+	virtual ~EpollLoop();
+	bool addSocket(int fd);
+	void send(int fd, struct sockaddr_in *to, char *data, int size);
+	void flush();
+	void poll();
+	int recv(int fd, int (* enq)(void *, char *, int), void *queue);
+	const char *name() { return "epoll"; }
+};
+
+/**
+ * CLASS NAME: UringLoop
+ *
+ * DESCRIPTION: io_uring backend driven through the raw system calls.
+ * 				Every socket keeps URING_READS_PER_SOCKET reads armed on registered
+ * 				buffers (sized for the number of sockets given at construction), sends
+ * 				are queued as SENDMSG entries, and a single io_uring_enter per poll submits everything and reaps the completions.
+ */
+class UringLoop : public IoLoop {
+private:
+	struct SendSlot {
+		struct sockaddr_in to;
+		struct iovec iov;
+		struct msghdr hdr;
+		char data[IO_BUFFSIZE];
+	};
+	int ringfd;
+	unsigned *sqhead, *sqtail, *sqmask, *sqarray;
+	unsigned *cqhead, *cqtail, *cqmask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+	void *sqring, *cqring;
+	size_t sqringsize, cqringsize, sqessize;
+	unsigned sqentries;
+	unsigned queued;
+	int nrecvbuffs;
+	char *recvbuffs;
+	vector<int> recvfd;
+	vector<int> freerecv;
+	SendSlot *sendslots;
+	vector<int> freesend;
+	// socket -> (buffer, length) completed and not delivered yet
+	map<int, vector<pair<int, int> > > ready;
+	struct io_uring_sqe *getSqe();
+	int enter(unsigned submit, unsigned wait);
+	void armRead(int fd);
+	void reap();
+public:
+	UringLoop(int sockets);
+	virtual ~UringLoop();
+	bool init();
+	bool addSocket(int fd);
+	void send(int fd, struct sockaddr_in *to, char *data, int size);
+	void flush();
+	void poll();
+	int recv(int fd, int (* enq)(void *, char *, int), void *queue);
+	const char *name() { return "io_uring"; }
+};
+
+#endif /* _IOLOOP_H_ */
@@ -12,6 +12,7 @@
 Log::Log(Params *p) {
 	par = p;
 	firstTime = false;
+	level = p->LOG_LEVEL;
 }
 
 /**
@@ -20,6 +21,7 @@ Log::Log(Params *p) {
 Log::Log(const Log &anotherLog) {
 	this->par = anotherLog.par;
 	this->firstTime = anotherLog.firstTime;
+	this->level = anotherLog.level;
 }
 
 /**
@@ -28,6 +30,7 @@ Log::Log(const Log &anotherLog) {
 Log& Log::operator = (const Log& anotherLog) {
 	this->par = anotherLog.par;
 	this->firstTime = anotherLog.firstTime;
+	this->level = anotherLog.level;
 	return *this;
 }
 
@@ -36,225 +39,230 @@ Log& Log::operator = (const Log& anotherLog) {
  */
 Log::~Log() {}
 
+// Shared by every Log, as the files they write to
+static LogWriter logWriter;
+
 /**
- * FUNCTION NAME: LOG
- *
- * DESCRIPTION: Print out to file dbg.log, along with Address of node.
+ * Constructor
  */
-void Log::LOG(Address *addr, const char * str, ...) {
-
-	static FILE *fp;
-	static FILE *fp2;
-	va_list vararglist;
-	static char buffer[30000];
-	static int numwrites;
-	static char stdstring[30];
-	static char stdstring2[40];
-	static char stdstring3[40]; 
-	static int dbg_opened=0;
-
-	if(dbg_opened != 639){
-		numwrites=0;
-
-		stdstring2[0]=0;
-
-		strcpy(stdstring3, stdstring2);
-
-		strcat(stdstring2, DBG_LOG);
-		strcat(stdstring3, STATS_LOG);
-
-		fp = fopen(stdstring2, "w");
-		fp2 = fopen(stdstring3, "w");
-
-		dbg_opened=639;
-	}
-	else 
-
-	sprintf(stdstring, "%d.%d.%d.%d:%d ", addr->addr[0], addr->addr[1], addr->addr[2], addr->addr[3], *(short *)&addr->addr[4]);
+LogWriter::LogWriter(): binary(false), dbg(NULL), stats(NULL), bin(NULL), firstRecord(true), stopping(false) {}
 
-	va_start(vararglist, str);
-	vsprintf(buffer, str, vararglist);
-	va_end(vararglist);
-
-	if (!firstTime) {
-		int magicNumber = 0;
-		string magic = MAGIC_NUMBER;
-		int len = magic.length();
-		for ( int i = 0; i < len; i++ ) {
-			magicNumber += (int)magic.at(i);
+/**
+ * Destructor: write out what is left and stop the writer
+ */
+LogWriter::~LogWriter() {
+	if ( writer.joinable() ) {
+		stopping = true;
+		wake.notify_one();
+		writer.join();
+		if ( binary ) {
+			fclose(bin);
+		}
+		else {
+			fclose(dbg);
+			fclose(stats);
 		}
-		fprintf(fp, "%x\n", magicNumber);
-		firstTime = true;
-	}
-
-	if(memcmp(buffer, "#STATSLOG#", 10)==0){
-		fprintf(fp2, "\n %s", stdstring);
-		fprintf(fp2, "[%d] ", par->getcurrtime());
-
-		fprintf(fp2, buffer);
 	}
-	else{
-		fprintf(fp, "\n %s", stdstring);
-		fprintf(fp, "[%d] ", par->getcurrtime());
-		fprintf(fp, buffer);
+}
 
+/**
+ * FUNCTION NAME: start
+ *
+ * DESCRIPTION: Open the log files of the logFORMAT and start the writer thread
+ */
+void LogWriter::start(int logFormat) {
+	binary = (logFormat == BINARY_LOG);
+	if ( binary ) {
+		bin = fopen(DBG_BIN, "w");
+		fwrite(LOG_BIN_HEADER, 1, LOG_BIN_HEADER_SIZE, bin);
 	}
-
-	if(++numwrites >= MAXWRITES){
-		fflush(fp);
-		fflush(fp2);
-		numwrites=0;
+	else {
+		dbg = fopen(DBG_LOG, "w");
+		stats = fopen(STATS_LOG, "w");
 	}
-
+	dbgBuffer.reserve(LOG_BATCH_BYTES + LOG_TEXT_SIZE * 2);
+	statsBuffer.reserve(LOG_BATCH_BYTES + LOG_TEXT_SIZE * 2);
+	binBuffer.reserve(LOG_BATCH_BYTES + LOG_TEXT_SIZE * 2);
+	writer = thread(&LogWriter::run, this);
 }
 
 /**
- * FUNCTION NAME: logNodeAdd
+ * FUNCTION NAME: claim
  *
- * DESCRIPTION: To Log a node add
+ * DESCRIPTION: Reserve a record, waiting for the writer while the ring is full
  */
-void Log::logNodeAdd(Address *thisNode, Address *addedAddr) {
-	static char stdstring[100];
-	sprintf(stdstring, "Node %d.%d.%d.%d:%d joined at time %d", addedAddr->addr[0], addedAddr->addr[1], addedAddr->addr[2], addedAddr->addr[3], *(short *)&addedAddr->addr[4], par->getcurrtime());
-    LOG(thisNode, stdstring);
+LogRecord *LogWriter::claim(unsigned long &ticket, int logFormat) {
+	call_once(startOnce, &LogWriter::start, this, logFormat);
+	LogRecord *record;
+	while ( (record = ring.claim(ticket)) == NULL ) {
+		wake.notify_one();
+		this_thread::yield();
+	}
+	return record;
 }
 
 /**
- * FUNCTION NAME: logNodeRemove
+ * FUNCTION NAME: publish
  *
- * DESCRIPTION: To log a node remove
+ * DESCRIPTION: Hand a filled record to the writer, waking it up every LOG_WAKE_RECORDS records
  */
-void Log::logNodeRemove(Address *thisNode, Address *removedAddr) {
-	static char stdstring[30];
-	sprintf(stdstring, "Node %d.%d.%d.%d:%d removed at time %d", removedAddr->addr[0], removedAddr->addr[1], removedAddr->addr[2], removedAddr->addr[3], *(short *)&removedAddr->addr[4], par->getcurrtime());
-    LOG(thisNode, stdstring);
+void LogWriter::publish(unsigned long ticket) {
+	ring.publish(ticket);
+	if ( (ticket & (LOG_WAKE_RECORDS - 1)) == LOG_WAKE_RECORDS - 1 ) {
+		wake.notify_one();
+	}
 }
 
 /**
- * FUNCTION NAME: logCreateSuccess
+ * FUNCTION NAME: run
  *
- * DESCRTION: Call this function after successfully create a key value pair
+ * DESCRIPTION: Body of the writer thread
  */
-void Log::logCreateSuccess(Address * address, bool isCoordinator, int transID, string key, string value){
-	static char stdstring[100];
-	string str;
-	if (isCoordinator)
-		str = "coordinator";
-	else
-		str = "server";
-	sprintf(stdstring, "%s: create success at time %d, transID=%d, key=%s, value=%s", str.c_str(), par->getcurrtime(), transID, key.c_str(), value.c_str());
-    LOG(address, stdstring);
+void LogWriter::run() {
+	while ( true ) {
+		if ( drain() ) {
+			continue;
+		}
+		if ( stopping ) {
+			// a record published while stopping was set is still drained
+			if ( !drain() ) {
+				return;
+			}
+			continue;
+		}
+		unique_lock<mutex> guard(lock);
+		wake.wait_for(guard, chrono::milliseconds(LOG_IDLE_MS));
+	}
 }
 
 /**
- * FUNCTION NAME: logReadSuccess
+ * FUNCTION NAME: drain
+ *
+ * DESCRIPTION: Format every published record, writing out every LOG_BATCH_BYTES and at the end
  *
- * DESCRIPTION: Call this function after successfully reading a key
+ * RETURNS:
+ * true if there was any record
  */
-void Log::logReadSuccess(Address * address, bool isCoordinator, int transID, string key, string value){
-    static char stdstring[100];
-	string str;
-	if (isCoordinator)
-		str = "coordinator";
-	else
-		str = "server";
-	sprintf(stdstring, "%s: read success at time %d, transID=%d, key=%s, value=%s", str.c_str(), par->getcurrtime(), transID, key.c_str(), value.c_str());
-    LOG(address, stdstring);
+bool LogWriter::drain() {
+	bool any = false;
+	LogRecord *record;
+	while ( (record = ring.peek()) != NULL ) {
+		format(record);
+		ring.release();
+		any = true;
+		if ( dbgBuffer.size() >= LOG_BATCH_BYTES || statsBuffer.size() >= LOG_BATCH_BYTES || binBuffer.size() >= LOG_BATCH_BYTES ) {
+			write();
+		}
+	}
+	if ( any ) {
+		write();
+	}
+	return any;
 }
 
 /**
- * FUNCTION NAME: logUpdateSuccess
+ * FUNCTION NAME: write
  *
- * DESCRIPTION: Call this function after successfully updating a key
+ * DESCRIPTION: Write the formatted records out
  */
-void Log::logUpdateSuccess(Address * address, bool isCoordinator, int transID, string key, string newValue){
-    static char stdstring[100];
-	string str;
-	if (isCoordinator)
-		str = "coordinator";
-	else
-		str = "server";
-	sprintf(stdstring, "%s: update success at time %d, transID=%d, key=%s, value=%s", str.c_str(), par->getcurrtime(), transID, key.c_str(), newValue.c_str());
-    LOG(address, stdstring);
+void LogWriter::write() {
+	if ( binary ) {
+		fwrite(binBuffer.data(), 1, binBuffer.size(), bin);
+		fflush(bin);
+		binBuffer.clear();
+		return;
+	}
+	fwrite(dbgBuffer.data(), 1, dbgBuffer.size(), dbg);
+	fwrite(statsBuffer.data(), 1, statsBuffer.size(), stats);
+	fflush(dbg);
+	fflush(stats);
+	dbgBuffer.clear();
+	statsBuffer.clear();
 }
 
 /**
- * FUNCTION NAME: logDeleteSuccess
+ * FUNCTION NAME: format
  *
- * DESCRIPTION: Call this function after successfully deleting a key
+ * DESCRIPTION: Format or encode a record into the buffers
  */
-void Log::logDeleteSuccess(Address * address, bool isCoordinator, int transID, string key){
-    static char stdstring[100];
-	string str;
-	if (isCoordinator)
-		str = "coordinator";
-	else
-		str = "server";
-	sprintf(stdstring, "%s: delete success at time %d, transID=%d, key=%s", str.c_str(), par->getcurrtime(), transID, key.c_str());
-    LOG(address, stdstring);
+void LogWriter::format(LogRecord *record) {
+	if ( binary ) {
+		encoder.encode(record, binBuffer);
+		return;
+	}
+	formatLogRecord(record, firstRecord, dbgBuffer, statsBuffer);
+	if ( record->kind != LOG_MAGIC ) {
+		firstRecord = false;
+	}
 }
 
 /**
- * FUNCTION NAME: logCreateFail
+ * FUNCTION NAME: claim
  *
- * DESCRIPTION: Call this function if CREATE failed
+ * DESCRIPTION: Reserve a record of this node for the current time, the first record of
+ * 				this Log being preceded by the magic number
  */
-void Log::logCreateFail(Address * address, bool isCoordinator, int transID, string key, string value){
-	static char stdstring[100];
-	string str;
-	if (isCoordinator)
-		str = "coordinator";
-	else
-		str = "server";
-	sprintf(stdstring, "%s: create fail at time %d, transID=%d, key=%s, value=%s", str.c_str(), par->getcurrtime(), transID, key.c_str(), value.c_str());
-    LOG(address, stdstring);
+LogRecord *Log::claim(Address *addr, int kind, unsigned long &ticket) {
+	if (!firstTime) {
+		logWriter.claim(ticket, par->LOG_FORMAT)->kind = LOG_MAGIC;
+		logWriter.publish(ticket);
+		firstTime = true;
+	}
+	LogRecord *record = logWriter.claim(ticket, par->LOG_FORMAT);
+	record->kind = kind;
+	record->time = par->getcurrtime();
+	memcpy(record->addr, addr->addr, sizeof(record->addr));
+	return record;
 }
 
-
 /**
- * FUNCTION NAME: logReadFail
+ * FUNCTION NAME: LOG
  *
- * DESCRIPTION: Call this function if READ failed
+ * DESCRIPTION: Print out to file dbg.log, along with Address of node.
+ * 				Messages longer than LOG_TEXT_SIZE are cut.
  */
-void Log::logReadFail(Address * address, bool isCoordinator, int transID, string key){
-    static char stdstring[100];
-	string str;
-	if (isCoordinator)
-		str = "coordinator";
-	else
-		str = "server";
-	sprintf(stdstring, "%s: read fail at time %d, transID=%d, key=%s", str.c_str(), par->getcurrtime(), transID, key.c_str());
-    LOG(address, stdstring);
+void Log::LOG(Address *addr, const char * str, ...) {
+	unsigned long ticket;
+	LogRecord *record = claim(addr, LOG_TEXT, ticket);
+	va_list vararglist;
+	va_start(vararglist, str);
+	int length = vsnprintf(record->text, LOG_TEXT_SIZE, str, vararglist);
+	va_end(vararglist);
+	record->textLength = max(0, min(length, LOG_TEXT_SIZE - 1));
+	logWriter.publish(ticket);
 }
 
 /**
- * FUNCTION NAME: logUpdateFail
+ * FUNCTION NAME: logOperation
  *
- * DESCRIPTION: Call this function if UPDATE failed
+ * DESCRIPTION: Log a CRUD operation, key and value being cut to fit the record
  */
-void Log::logUpdateFail(Address * address, bool isCoordinator, int transID, string key, string newValue){
-    static char stdstring[100];
-	string str;
-	if (isCoordinator)
-		str = "coordinator";
-	else
-		str = "server";
-	sprintf(stdstring, "%s: update fail at time %d, transID=%d, key=%s, value=%s", str.c_str(), par->getcurrtime(), transID, key.c_str(), newValue.c_str());
-    LOG(address, stdstring);
+void Log::logOperation(int kind, Address *address, bool isCoordinator, bool success, int transID, const string &key, const string *value) {
+	unsigned long ticket;
+	LogRecord *record = claim(address, kind, ticket);
+	record->coordinator = isCoordinator;
+	record->success = success;
+	record->transID = transID;
+	record->keyLength = min((int)key.size(), LOG_TEXT_SIZE);
+	memcpy(record->text, key.data(), record->keyLength);
+	record->textLength = record->keyLength;
+	record->hasValue = (value != NULL);
+	if ( value != NULL ) {
+		int valueLength = min((int)value->size(), LOG_TEXT_SIZE - record->keyLength);
+		memcpy(record->text + record->keyLength, value->data(), valueLength);
+		record->textLength += valueLength;
+	}
+	logWriter.publish(ticket);
 }
 
 /**
- * FUNCTION NAME: logDeleteFail
+ * FUNCTION NAME: logNode
  *
- * DESCRIPTION: Call this function if DELETE failed
+ * DESCRIPTION: Log a node add or remove
  */
-void Log::logDeleteFail(Address * address, bool isCoordinator, int transID, string key){
-    static char stdstring[100];
-	string str;
-	if (isCoordinator)
-		str = "coordinator";
-	else
-		str = "server";
-	sprintf(stdstring, "%s: delete fail at time %d, transID=%d, key=%s", str.c_str(), par->getcurrtime(), transID, key.c_str());
-    LOG(address, stdstring);
+void Log::logNode(int kind, Address *thisNode, Address *otherNode) {
+	unsigned long ticket;
+	LogRecord *record = claim(thisNode, kind, ticket);
+	memcpy(record->other, otherNode->addr, sizeof(record->other));
+	logWriter.publish(ticket);
 }
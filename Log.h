@@ -10,43 +10,154 @@
 #include "stdincludes.h"
 #include "Params.h"
 #include "Member.h"
+#include "LogRing.h"
+#include "LogCodec.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 /*
  * Macros
  */
-// number of writes after which to flush file
-#define MAXWRITES 1
-#define MAGIC_NUMBER "CS425"
-#define DBG_LOG "dbg.log"
-#define STATS_LOG "stats.log"
+// bytes formatted by the log writer before they are written out
+#define LOG_BATCH_BYTES 65536
+// records published between two wake ups of the log writer, a power of two
+#define LOG_WAKE_RECORDS 256
+// milliseconds after which the log writer also picks up fewer records
+#define LOG_IDLE_MS 100
+// log levels: debug messages of the application and the protocols, CRUD operations served
+// by every replica, outcomes of the CRUD operations at their coordinator and membership changes
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_SERVER 1
+#define LOG_LEVEL_EVENT 2
+// lowest level compiled in, e.g. make LOG_MIN_LEVEL=2 for coordinator events only
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+/**
+ * CLASS NAME: LogWriter
+ *
+ * DESCRIPTION: Background thread formatting the records of the loggers into dbg.log and
+ * 				stats.log, or with LOG_FORMAT: BINARY encoding them into dbg.bin (see LogEncoder).
+ * 				The files are opened and the thread started by the first record.
+ * 				Everything logged is written out when the program exits.
+ */
+class LogWriter {
+private:
+	LogRing ring;
+	bool binary;
+	FILE *dbg;
+	FILE *stats;
+	FILE *bin;
+	string dbgBuffer;
+	string statsBuffer;
+	string binBuffer;
+	LogEncoder encoder;
+	bool firstRecord;
+	once_flag startOnce;
+	thread writer;
+	mutex lock;
+	condition_variable wake;
+	atomic<bool> stopping;
+	void start(int logFormat);
+	void run();
+	bool drain();
+	void format(LogRecord *record);
+	void write();
+public:
+	LogWriter();
+	~LogWriter();
+	LogRecord *claim(unsigned long &ticket, int logFormat);
+	void publish(unsigned long ticket);
+};
 
 /**
  * CLASS NAME: Log
  *
- * DESCRIPTION: Functions to log messages in a debug log
+ * DESCRIPTION: Functions to log messages in a debug log.
+ * 				A call only fills a record of the LogWriter, which formats and writes it later.
+ * 				Messages below LOG_MIN_LEVEL are compiled out: the level checks and the
+ * 				logging functions taking a level are inline, so such a call folds away with
+ * 				its arguments. The other messages are kept from LOG_LEVEL on.
  */
 class Log{
 private:
 	Params *par;
 	bool firstTime;
+	int level;
+	LogRecord *claim(Address *addr, int kind, unsigned long &ticket);
+	void logNode(int kind, Address *thisNode, Address *otherNode);
+	void logOperation(int kind, Address *address, bool isCoordinator, bool success, int transID, const string &key, const string *value);
+	bool operationEnabled(bool isCoordinator) {
+		return isCoordinator ? enabled<LOG_LEVEL_EVENT>() : enabled<LOG_LEVEL_SERVER>();
+	}
 public:
 	Log(Params *p);
 	Log(const Log &anotherLog);
 	Log& operator = (const Log &anotherLog);
 	virtual ~Log();
+	template <int messageLevel> bool enabled() {
+		return messageLevel >= LOG_MIN_LEVEL && messageLevel >= level;
+	}
 	void LOG(Address *, const char * str, ...);
-	void logNodeAdd(Address *, Address *);
-	void logNodeRemove(Address *, Address *);
+	template <class... Args> void debug(Address *addr, const char *str, Args... args) {
+		if ( enabled<LOG_LEVEL_DEBUG>() ) {
+			LOG(addr, str, args...);
+		}
+	}
+	void logNodeAdd(Address *thisNode, Address *addedAddr) {
+		if ( enabled<LOG_LEVEL_EVENT>() ) {
+			logNode(LOG_NODE_ADD, thisNode, addedAddr);
+		}
+	}
+	void logNodeRemove(Address *thisNode, Address *removedAddr) {
+		if ( enabled<LOG_LEVEL_EVENT>() ) {
+			logNode(LOG_NODE_REMOVE, thisNode, removedAddr);
+		}
+	}
 	// success
-	void logCreateSuccess(Address * address, bool isCoordinator, int transID, string key, string value);
-	void logReadSuccess(Address * address, bool isCoordinator, int transID, string key, string value);
-	void logUpdateSuccess(Address * address, bool isCoordinator, int transID, string key, string newValue);
-	void logDeleteSuccess(Address * address, bool isCoordinator, int transID, string key);
+	void logCreateSuccess(Address * address, bool isCoordinator, int transID, const string &key, const string &value) {
+		if ( operationEnabled(isCoordinator) ) {
+			logOperation(LOG_CREATE, address, isCoordinator, true, transID, key, &value);
+		}
+	}
+	void logReadSuccess(Address * address, bool isCoordinator, int transID, const string &key, const string &value) {
+		if ( operationEnabled(isCoordinator) ) {
+			logOperation(LOG_READ, address, isCoordinator, true, transID, key, &value);
+		}
+	}
+	void logUpdateSuccess(Address * address, bool isCoordinator, int transID, const string &key, const string &newValue) {
+		if ( operationEnabled(isCoordinator) ) {
+			logOperation(LOG_UPDATE, address, isCoordinator, true, transID, key, &newValue);
+		}
+	}
+	void logDeleteSuccess(Address * address, bool isCoordinator, int transID, const string &key) {
+		if ( operationEnabled(isCoordinator) ) {
+			logOperation(LOG_DELETE, address, isCoordinator, true, transID, key, NULL);
+		}
+	}
 	// fail
-	void logCreateFail(Address * address, bool isCoordinator, int transID, string key, string value);
-	void logReadFail(Address * address, bool isCoordinator, int transID, string key);
-	void logUpdateFail(Address * address, bool isCoordinator, int transID, string key, string newValue);
-	void logDeleteFail(Address * address, bool isCoordinator, int transID, string key);
+	void logCreateFail(Address * address, bool isCoordinator, int transID, const string &key, const string &value) {
+		if ( operationEnabled(isCoordinator) ) {
+			logOperation(LOG_CREATE, address, isCoordinator, false, transID, key, &value);
+		}
+	}
+	void logReadFail(Address * address, bool isCoordinator, int transID, const string &key) {
+		if ( operationEnabled(isCoordinator) ) {
+			logOperation(LOG_READ, address, isCoordinator, false, transID, key, NULL);
+		}
+	}
+	void logUpdateFail(Address * address, bool isCoordinator, int transID, const string &key, const string &newValue) {
+		if ( operationEnabled(isCoordinator) ) {
+			logOperation(LOG_UPDATE, address, isCoordinator, false, transID, key, &newValue);
+		}
+	}
+	void logDeleteFail(Address * address, bool isCoordinator, int transID, const string &key) {
+		if ( operationEnabled(isCoordinator) ) {
+			logOperation(LOG_DELETE, address, isCoordinator, false, transID, key, NULL);
+		}
+	}
 };
 
 #endif /* _LOG_H_ */
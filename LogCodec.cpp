@@ -0,0 +1,226 @@
+/**********************************
+ * FILE NAME: LogCodec.cpp
+ *
+ * DESCRIPTION: Definition of the text and binary encodings of the log records
+ **********************************/
+
+#include "LogCodec.h"
+
+/**
+ * FUNCTION NAME: formatLogRecord
+ *
+ * DESCRIPTION: The line of a message is "\n <address> [<time>] <message>", with no address
+ * 				on the very first line, and the first record of every Log is its magic number.
+ */
+void formatLogRecord(const LogRecord *record, bool first, string &dbg, string &stats) {
+	char line[LOG_TEXT_SIZE * 2];
+	const char *operations[] = { "create", "read", "update", "delete" };
+	int length = 0;
+
+	if ( record->kind == LOG_MAGIC ) {
+		int magicNumber = 0;
+		string magic = MAGIC_NUMBER;
+		int len = magic.length();
+		for ( int i = 0; i < len; i++ ) {
+			magicNumber += (int)magic.at(i);
+		}
+		length = sprintf(line, "%x\n", magicNumber);
+		dbg.append(line, length);
+		return;
+	}
+
+	length = sprintf(line, "\n ");
+	if ( !first ) {
+		length += sprintf(line + length, "%d.%d.%d.%d:%d ", record->addr[0], record->addr[1], record->addr[2], record->addr[3], *(short *)&record->addr[4]);
+	}
+	length += sprintf(line + length, "[%d] ", record->time);
+
+	char *body = line + length;
+	switch ( record->kind ) {
+		case LOG_TEXT:
+			memcpy(body, record->text, record->textLength);
+			length += record->textLength;
+			break;
+		case LOG_NODE_ADD:
+		case LOG_NODE_REMOVE:
+			length += sprintf(body, "Node %d.%d.%d.%d:%d %s at time %d", record->other[0], record->other[1], record->other[2], record->other[3], *(short *)&record->other[4], record->kind == LOG_NODE_ADD ? "joined" : "removed", record->time);
+			break;
+		default:
+			length += sprintf(body, "%s: %s %s at time %d, transID=%d, key=%.*s", record->coordinator ? "coordinator" : "server", operations[record->kind - LOG_CREATE], record->success ? "success" : "fail", record->time, record->transID, record->keyLength, record->text);
+			if ( record->hasValue ) {
+				length += sprintf(line + length, ", value=%.*s", record->textLength - record->keyLength, record->text + record->keyLength);
+			}
+			break;
+	}
+
+	if ( length - (body - line) >= 10 && memcmp(body, "#STATSLOG#", 10) == 0 ) {
+		stats.append(line, length);
+	}
+	else {
+		dbg.append(line, length);
+	}
+}
+
+/**
+ * FUNCTION NAME: putNode
+ */
+void LogEncoder::putNode(string &out, const char *addr) {
+	int id;
+	short port;
+	memcpy(&id, addr, sizeof(int));
+	memcpy(&port, addr + 4, sizeof(short));
+	putVarint(out, (unsigned int)id);
+	putVarint(out, zigzag(port));
+}
+
+/**
+ * FUNCTION NAME: putString
+ *
+ * DESCRIPTION: Append the reference of a string to out, defining it in defines on first use
+ */
+void LogEncoder::putString(string &out, string &defines, const char *data, int size) {
+	string s(data, size);
+	map<string, unsigned long>::iterator search = strings.find(s);
+	if ( search == strings.end() ) {
+		search = strings.insert(make_pair(s, strings.size())).first;
+		defines.push_back((char)LOG_STRING);
+		putVarint(defines, size);
+		defines.append(s);
+	}
+	putVarint(out, search->second);
+}
+
+/**
+ * FUNCTION NAME: encode
+ *
+ * DESCRIPTION: Append the binary form of a record to out
+ */
+void LogEncoder::encode(const LogRecord *record, string &out) {
+	string defines;
+	string body;
+	body.push_back((char)record->kind);
+	if ( record->kind != LOG_MAGIC ) {
+		putVarint(body, zigzag(record->time - lastTime));
+		lastTime = record->time;
+		putNode(body, record->addr);
+		switch ( record->kind ) {
+			case LOG_TEXT:
+				putString(body, defines, record->text, record->textLength);
+				break;
+			case LOG_NODE_ADD:
+			case LOG_NODE_REMOVE:
+				putNode(body, record->other);
+				break;
+			default:
+				body.push_back((char)((record->coordinator ? LOG_FLAG_COORDINATOR : 0) | (record->success ? LOG_FLAG_SUCCESS : 0) | (record->hasValue ? LOG_FLAG_VALUE : 0)));
+				putVarint(body, zigzag(record->transID));
+				putString(body, defines, record->text, record->keyLength);
+				if ( record->hasValue ) {
+					putString(body, defines, record->text + record->keyLength, record->textLength - record->keyLength);
+				}
+				break;
+		}
+	}
+	out.append(defines);
+	out.append(body);
+}
+
+/**
+ * FUNCTION NAME: getNode
+ */
+bool LogDecoder::getNode(const char *data, int size, int &pos, char *addr) {
+	unsigned long id, port;
+	if ( !getVarint(data, size, pos, id) || !getVarint(data, size, pos, port) ) {
+		return false;
+	}
+	int i = (int)id;
+	short p = (short)unzigzag(port);
+	memcpy(addr, &i, sizeof(int));
+	memcpy(addr + 4, &p, sizeof(short));
+	return true;
+}
+
+/**
+ * FUNCTION NAME: getString
+ */
+bool LogDecoder::getString(const char *data, int size, int &pos, string &s) {
+	unsigned long ref;
+	if ( !getVarint(data, size, pos, ref) || ref >= strings.size() ) {
+		return false;
+	}
+	s = strings[ref];
+	return true;
+}
+
+/**
+ * FUNCTION NAME: decode
+ *
+ * DESCRIPTION: Read the record at pos, along with the strings defined before it
+ *
+ * RETURNS:
+ * false at the end of the log or on a malformed record
+ */
+bool LogDecoder::decode(const char *data, int size, int &pos, LogRecord *record) {
+	while ( pos < size && (unsigned char)data[pos] == LOG_STRING ) {
+		unsigned long length;
+		pos++;
+		if ( !getVarint(data, size, pos, length) || length > (unsigned long)(size - pos) ) {
+			return false;
+		}
+		strings.push_back(string(data + pos, length));
+		pos += length;
+	}
+	if ( pos >= size ) {
+		return false;
+	}
+	record->kind = data[pos++];
+	if ( record->kind == LOG_MAGIC ) {
+		return true;
+	}
+	if ( record->kind > LOG_DELETE || record->kind < LOG_MAGIC ) {
+		return false;
+	}
+	unsigned long time;
+	if ( !getVarint(data, size, pos, time) || !getNode(data, size, pos, record->addr) ) {
+		return false;
+	}
+	lastTime += unzigzag(time);
+	record->time = lastTime;
+
+	string key, value;
+	switch ( record->kind ) {
+		case LOG_TEXT:
+			if ( !getString(data, size, pos, key) ) {
+				return false;
+			}
+			break;
+		case LOG_NODE_ADD:
+		case LOG_NODE_REMOVE:
+			return getNode(data, size, pos, record->other);
+		default: {
+			unsigned long transID;
+			if ( pos >= size ) {
+				return false;
+			}
+			int flags = data[pos++];
+			record->coordinator = flags & LOG_FLAG_COORDINATOR;
+			record->success = flags & LOG_FLAG_SUCCESS;
+			record->hasValue = flags & LOG_FLAG_VALUE;
+			if ( !getVarint(data, size, pos, transID) || !getString(data, size, pos, key) ) {
+				return false;
+			}
+			record->transID = unzigzag(transID);
+			if ( record->hasValue && !getString(data, size, pos, value) ) {
+				return false;
+			}
+			break;
+		}
+	}
+	// the strings were cut to fit a record when logged
+	record->keyLength = min((int)key.size(), LOG_TEXT_SIZE);
+	memcpy(record->text, key.data(), record->keyLength);
+	int valueLength = min((int)value.size(), LOG_TEXT_SIZE - record->keyLength);
+	memcpy(record->text + record->keyLength, value.data(), valueLength);
+	record->textLength = record->keyLength + valueLength;
+	return true;
+}
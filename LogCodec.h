@@ -0,0 +1,79 @@
+/**********************************
+ * FILE NAME: LogCodec.h
+ *
+ * DESCRIPTION: Header file of the text and binary encodings of the log records
+ **********************************/
+
+#ifndef LOGCODEC_H_
+#define LOGCODEC_H_
+
+/*
+ * Macros
+ */
+#define MAGIC_NUMBER "CS425"
+#define DBG_LOG "dbg.log"
+#define STATS_LOG "stats.log"
+#define DBG_BIN "dbg.bin"
+// first bytes of a binary event log, the last one being the version of the format
+#define LOG_BIN_HEADER "KVLOG\x01"
+#define LOG_BIN_HEADER_SIZE 6
+// binary record defining the next string of the string table
+#define LOG_STRING 0x7f
+// flags of the binary CRUD records
+#define LOG_FLAG_COORDINATOR 0x01
+#define LOG_FLAG_SUCCESS 0x02
+#define LOG_FLAG_VALUE 0x04
+
+#include "stdincludes.h"
+#include "LogRing.h"
+#include "Varint.h"
+
+/**
+ * FUNCTION NAME: formatLogRecord
+ *
+ * DESCRIPTION: Append the text line of a record to dbg or, for a message starting with
+ * 				#STATSLOG#, to stats. first tells if it is the first line of the log.
+ */
+void formatLogRecord(const LogRecord *record, bool first, string &dbg, string &stats);
+
+/**
+ * CLASS NAME: LogEncoder
+ *
+ * DESCRIPTION: Binary event log writer.
+ * 				A record is its kind byte, the zigzag varint time since the previous record,
+ * 				the varint id and zigzag port of the node, then per kind:
+ * 				- LOG_TEXT: varint reference of the message
+ * 				- LOG_NODE_ADD, LOG_NODE_REMOVE: id and port of the other node
+ * 				- CRUD: flags byte, zigzag transID, varint references of the key and value
+ * 				LOG_MAGIC is its kind byte alone. Keys, values and messages are kept once
+ * 				in a string table: the first use of a string is preceded by a LOG_STRING
+ * 				record holding its varint length and bytes, the next string id.
+ */
+class LogEncoder {
+private:
+	map<string, unsigned long> strings;
+	int lastTime;
+	void putNode(string &out, const char *addr);
+	void putString(string &out, string &defines, const char *data, int size);
+public:
+	LogEncoder(): lastTime(0) {}
+	void encode(const LogRecord *record, string &out);
+};
+
+/**
+ * CLASS NAME: LogDecoder
+ *
+ * DESCRIPTION: Reads back the records written by a LogEncoder
+ */
+class LogDecoder {
+private:
+	vector<string> strings;
+	int lastTime;
+	bool getNode(const char *data, int size, int &pos, char *addr);
+	bool getString(const char *data, int size, int &pos, string &s);
+public:
+	LogDecoder(): lastTime(0) {}
+	bool decode(const char *data, int size, int &pos, LogRecord *record);
+};
+
+#endif /* LOGCODEC_H_ */
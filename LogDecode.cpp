@@ -0,0 +1,62 @@
+/**********************************
+ * FILE NAME: LogDecode.cpp
+ *
+ * DESCRIPTION: Offline decoder of the binary event log.
+ * 				Renders dbg.bin into the dbg.log and stats.log the text logger writes.
+ *
+ * 				usage: ./LogDecode [dbg.bin [dbg.log [stats.log]]]
+ **********************************/
+
+#include "LogCodec.h"
+
+/**********************************
+ * FUNCTION NAME: main
+ **********************************/
+int main(int argc, char *argv[]) {
+	const char *binPath = argc > 1 ? argv[1] : DBG_BIN;
+	const char *dbgPath = argc > 2 ? argv[2] : DBG_LOG;
+	const char *statsPath = argc > 3 ? argv[3] : STATS_LOG;
+
+	ifstream in(binPath, ios::binary);
+	if ( !in ) {
+		cout<<"Could not open "<<binPath<<endl;
+		return FAILURE;
+	}
+	string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+	if ( data.size() < LOG_BIN_HEADER_SIZE || data.compare(0, LOG_BIN_HEADER_SIZE, LOG_BIN_HEADER) != 0 ) {
+		cout<<binPath<<" is not a binary event log"<<endl;
+		return FAILURE;
+	}
+
+	FILE *dbg = fopen(dbgPath, "w");
+	FILE *stats = fopen(statsPath, "w");
+	if ( dbg == NULL || stats == NULL ) {
+		cout<<"Could not create "<<dbgPath<<" and "<<statsPath<<endl;
+		return FAILURE;
+	}
+
+	LogDecoder decoder;
+	LogRecord record;
+	string dbgText, statsText;
+	int pos = LOG_BIN_HEADER_SIZE;
+	bool first = true;
+	long records = 0;
+	while ( decoder.decode(data.data(), data.size(), pos, &record) ) {
+		formatLogRecord(&record, first, dbgText, statsText);
+		if ( record.kind != LOG_MAGIC ) {
+			first = false;
+		}
+		records++;
+	}
+	fwrite(dbgText.data(), 1, dbgText.size(), dbg);
+	fwrite(statsText.data(), 1, statsText.size(), stats);
+	fclose(dbg);
+	fclose(stats);
+
+	if ( pos < (int)data.size() ) {
+		cout<<"Malformed record at byte "<<pos<<" of "<<binPath<<", decoded "<<records<<" records"<<endl;
+		return FAILURE;
+	}
+	cout<<"Decoded "<<records<<" records ("<<data.size()<<" bytes) into "<<dbgText.size() + statsText.size()<<" bytes of text"<<endl;
+	return SUCCESS;
+}
@@ -0,0 +1,125 @@
+/**********************************
+ * FILE NAME: LogRing.h
+ *
+ * DESCRIPTION: Header file of the lock-free ring buffer between the loggers and the log writer
+ **********************************/
+
+#ifndef LOGRING_H_
+#define LOGRING_H_
+
+/*
+ * Macros
+ */
+// records the ring holds, a power of 2
+#define LOG_RING_SLOTS 8192
+// bytes of text a record carries, longer messages are cut
+#define LOG_TEXT_SIZE 480
+
+#include "stdincludes.h"
+#include <atomic>
+
+// what a log record holds, the writer formats it accordingly
+enum LogKind { LOG_MAGIC, LOG_TEXT, LOG_NODE_ADD, LOG_NODE_REMOVE, LOG_CREATE, LOG_READ, LOG_UPDATE, LOG_DELETE };
+
+/**
+ * STRUCT NAME: LogRecord
+ *
+ * DESCRIPTION: Fixed size binary log record.
+ * 				LOG_TEXT records carry a formatted message in text, the CRUD records carry
+ * 				the key in the first keyLength bytes of text followed by the value.
+ */
+struct LogRecord {
+	int kind;
+	int time;
+	char addr[6];
+	char other[6];
+	bool coordinator;
+	bool success;
+	bool hasValue;
+	int transID;
+	int keyLength;
+	int textLength;
+	char text[LOG_TEXT_SIZE];
+};
+
+/**
+ * CLASS NAME: LogRing
+ *
+ * DESCRIPTION: Bounded multi producer single consumer ring of LogRecords.
+ * 				Every slot carries a sequence number telling whose turn it is: a producer
+ * 				claims the slot at the tail with a compare and swap, fills it in place and
+ * 				publishes it by bumping its sequence; the consumer reads the slot at the
+ * 				head once published and hands it back to the producers of the next lap.
+ */
+class LogRing {
+private:
+	struct Slot {
+		atomic<unsigned long> seq;
+		LogRecord record;
+	};
+	Slot slots[LOG_RING_SLOTS];
+	// producers and consumer on their own cache lines
+	alignas(64) atomic<unsigned long> tail;
+	alignas(64) unsigned long head;
+public:
+	LogRing(): tail(0), head(0) {
+		for ( unsigned long i = 0; i < LOG_RING_SLOTS; i++ ) {
+			slots[i].seq.store(i, memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * FUNCTION NAME: claim
+	 *
+	 * DESCRIPTION: Reserve the record at the tail, to be filled and then published
+	 *
+	 * RETURNS:
+	 * the record, NULL if the ring is full
+	 */
+	LogRecord *claim(unsigned long &ticket) {
+		unsigned long pos = tail.load(memory_order_relaxed);
+		while ( true ) {
+			Slot &slot = slots[pos & (LOG_RING_SLOTS - 1)];
+			long diff = (long)slot.seq.load(memory_order_acquire) - (long)pos;
+			if ( diff == 0 ) {
+				if ( tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed) ) {
+					ticket = pos;
+					return &slot.record;
+				}
+			}
+			else if ( diff < 0 ) {
+				return NULL;
+			}
+			else {
+				pos = tail.load(memory_order_relaxed);
+			}
+		}
+	}
+
+	void publish(unsigned long ticket) {
+		slots[ticket & (LOG_RING_SLOTS - 1)].seq.store(ticket + 1, memory_order_release);
+	}
+
+	/**
+	 * FUNCTION NAME: peek
+	 *
+	 * DESCRIPTION: Consumer side: the published record at the head
+	 *
+	 * RETURNS:
+	 * the record, NULL if the ring is empty
+	 */
+	LogRecord *peek() {
+		Slot &slot = slots[head & (LOG_RING_SLOTS - 1)];
+		if ( slot.seq.load(memory_order_acquire) != head + 1 ) {
+			return NULL;
+		}
+		return &slot.record;
+	}
+
+	void release() {
+		slots[head & (LOG_RING_SLOTS - 1)].seq.store(head + LOG_RING_SLOTS, memory_order_release);
+		head++;
+	}
+};
+
+#endif /* LOGRING_H_ */
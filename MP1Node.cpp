@@ -16,7 +16,7 @@
  * You can add new members to the class if you think it
  * is necessary for your aic to work
  */
-MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Address *address)
+MP1Node::MP1Node(Member *member, Params *params, Transport *emul, Log *log, Address *address)
 {
     for (int i = 0; i < 6; i++)
     {
@@ -27,6 +27,21 @@ MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Addres
     this->log = log;
     this->par = params;
     this->memberNode->addr = *address;
+#ifdef STOCK_HARNESS
+    // the Params of the assignment harness have no MEMBERSHIP option
+    this->membership = GOSSIP_MEMBERSHIP;
+#else
+    this->membership = params->MEMBERSHIP;
+#endif
+    this->version = 0;
+    this->incarnation = 0;
+    this->seq = 0;
+    this->probeId = -1;
+    this->probeSentAt = -SWIM_PERIOD;
+    this->probeActive = false;
+    this->probeIndirect = false;
+    this->probeIndex = 0;
+    this->gossipRounds = metrics().counter("kv_gossip_rounds_total", "Protocol periods run by the membership protocol.", "node=\"" + address->getAddress() + "\"");
     initMemberListTable(this->memberNode);
 }
 
@@ -49,6 +64,7 @@ int MP1Node::recvLoop()
     }
     else
     {
+        TraceSpan span("MP1Node::recvLoop", &memberNode->addr);
         return emulNet->ENrecv(&(memberNode->addr), enqueueWrapper, NULL, 1, &(memberNode->mp1q));
     }
 }
@@ -79,18 +95,14 @@ void MP1Node::nodeStart(char *servaddrstr, short servport)
     // Self booting routines
     if (initThisNode(&joinaddr) == -1)
     {
-#ifdef DEBUGLOG
-        log->LOG(&memberNode->addr, "init_thisnode failed. Exit.");
-#endif
+        logDebug("init_thisnode failed. Exit.");
         exit(1);
     }
 
     if (!introduceSelfToGroup(&joinaddr))
     {
         finishUpThisNode();
-#ifdef DEBUGLOG
-        log->LOG(&memberNode->addr, "Unable to join self to group. Exiting.");
-#endif
+        logDebug("Unable to join self to group. Exiting.");
         exit(1);
     }
 
@@ -107,15 +119,31 @@ int MP1Node::initThisNode(Address *joinaddr)
     /*
 	 * This function is partially implemented and may require changes
 	 */
+    // A new life carries on from the current time, above the heartbeats of the earlier
+    // lives that peers may still list
+    memberNode->heartbeat = memberNode->inited ? par->getcurrtime() : 0;
     memberNode->bFailed = false;
     memberNode->inited = true;
     memberNode->inGroup = false;
     // node is up!
     memberNode->nnb = 0;
-    memberNode->heartbeat = 0;
     memberNode->pingCounter = TFAIL;
     memberNode->timeOutCounter = -1;
     initMemberListTable(memberNode);
+    // the suspicion levels and gossip progress of an earlier life are stale
+    detector = FailureDetector();
+    peers.clear();
+    // SWIM: a new life starts over, at an incarnation above the ones of the earlier lives
+    // that peers may remember the node dead at
+    incarnation = par->getcurrtime();
+    probeSentAt = -SWIM_PERIOD;
+    probeActive = false;
+    probeIndirect = false;
+    probeOrder.clear();
+    probeIndex = 0;
+    relays.clear();
+    updates.clear();
+    dead.clear();
 
     return 0;
 }
@@ -128,33 +156,26 @@ int MP1Node::initThisNode(Address *joinaddr)
 int MP1Node::introduceSelfToGroup(Address *joinaddr)
 {
     char *msg;
-#ifdef DEBUGLOG
-    static char s[1024];
-#endif
 
     if (0 == memcmp((char *)&(memberNode->addr.addr), (char *)&(joinaddr->addr), sizeof(memberNode->addr.addr)))
     {
         // I am the group booter (first process to join the group). Boot up the group
-#ifdef DEBUGLOG
-        log->LOG(&memberNode->addr, "Starting up group...");
-#endif
+        logDebug("Starting up group...");
         memberNode->inGroup = true;
     }
     else
     {
-        size_t size = sizeof(short) + sizeof(joinaddr->addr) + sizeof(long);
+        size_t size = sizeof(short) + sizeof(joinaddr->addr) + sizeof(long) + sizeof(int);
         msg = (char *)malloc(size * sizeof(char));
 
-        // create JOINREQ message: format of data is {struct Address myaddr}
+        // create JOINREQ message: format of data is {struct Address myaddr}, heartbeat, incarnation
         short msgType = JOINREQ;
         memcpy(msg, &msgType, sizeof(short));
         memcpy(msg + sizeof(short), memberNode->addr.addr, sizeof(memberNode->addr.addr));
         memcpy(msg + sizeof(short) + sizeof(memberNode->addr.addr), &memberNode->heartbeat, sizeof(long));
+        memcpy(msg + sizeof(short) + sizeof(memberNode->addr.addr) + sizeof(long), &incarnation, sizeof(int));
 
-#ifdef DEBUGLOG
-        sprintf(s, "Trying to join...");
-        log->LOG(&memberNode->addr, s);
-#endif
+        logDebug("Trying to join...");
 
         // send JOINREQ message to introducer member
         emulNet->ENsend(&memberNode->addr, joinaddr, msg, size);
@@ -187,6 +208,7 @@ void MP1Node::nodeLoop()
     {
         return;
     }
+    TraceSpan span("MP1Node::nodeLoop", &memberNode->addr);
 
     // Check my messages
     checkMessages();
@@ -206,14 +228,12 @@ void MP1Node::nodeLoop()
     memcpy(&id, &memberNode->addr.addr[0], sizeof(int));
     memcpy(&port, &memberNode->addr.addr[4], sizeof(short));
 
-    for (int i = 0; i < memberNode->memberList.size(); i++)
+    int self = memberNode->indexOfMember(id, port);
+    if (self != -1)
     {
-        if (memberNode->memberList[i].getid() == id && memberNode->memberList[i].getport() == port)
-        {
-            memberNode->memberList[i].setheartbeat(memberNode->heartbeat);
-            memberNode->memberList[i].settimestamp(memberNode->heartbeat);
-            break;
-        }
+        memberNode->memberList[self].setheartbeat(memberNode->heartbeat);
+        memberNode->memberList[self].settimestamp(memberNode->heartbeat);
+        touch(memberNode->memberList[self]);
     }
 
     return;
@@ -250,15 +270,23 @@ bool MP1Node::recvCallBack(void *env, char *data, int size)
     short type;
 
     memcpy(&type, data, sizeof(short));
+    if (membership == SWIM_MEMBERSHIP && type != JOINREQ)
+    {
+        swimHandle(data, size, type);
+        return true;
+    }
     if (type == JOINREQ)
     {
         Address address;
         long heartbeat;
+        int inc = 0;
 
         memcpy(&address.addr, data + sizeof(short), sizeof(address.addr));
         memcpy(&heartbeat, data + sizeof(short) + sizeof(address.addr), sizeof(long));
+        if (size >= (int)(sizeof(short) + sizeof(address.addr) + sizeof(long) + sizeof(int)))
+            memcpy(&inc, data + sizeof(short) + sizeof(address.addr) + sizeof(long), sizeof(int));
 
-        addMemberToList(address, heartbeat);
+        addMemberToList(address, heartbeat, inc);
     }
     else if (type == JOINREP)
     {
@@ -271,122 +299,236 @@ bool MP1Node::recvCallBack(void *env, char *data, int size)
     return true;
 }
 
-void MP1Node::addMemberToList(Address address, long heartbeat)
+void MP1Node::addMemberToList(Address address, long heartbeat, int incarnation)
 {
+    if (membership == SWIM_MEMBERSHIP)
+    {
+        // A node back from a crash may still be listed, or remembered dead, under the
+        // incarnation of its previous life: its new one overrides both
+        swimApply(address, incarnation, MEMBER_ALIVE);
+        swimSend(address, JOINREP, 0, NULL);
+        return;
+    }
     int id = 0;
     short port;
     memcpy(&id, &address.addr[0], sizeof(int));
     memcpy(&port, &address.addr[4], sizeof(short));
     MemberListEntry entry(id, port, heartbeat, memberNode->heartbeat);
-    if (indexInMembersList(entry) == -1)
+    int index = indexInMembersList(entry);
+    if (index == -1)
     {
-        memberNode->memberList.push_back(entry);
+        touch(entry);
+        memberNode->addMember(entry);
         log->logNodeAdd(&memberNode->addr, &address);
         memberNode->nnb++;
-        sendMembersList(address, JOINREP);
     }
+    else
+    {
+        // A node back from a crash before it was removed is still listed, under the
+        // heartbeat of its previous life: its new one is above it
+        MemberListEntry &known = memberNode->memberList[index];
+        if (known.getheartbeat() < heartbeat)
+        {
+            known.setheartbeat(heartbeat);
+            known.settimestamp(memberNode->heartbeat);
+            touch(known);
+        }
+    }
+    detector.heartbeat(address.getAddress(), memberNode->heartbeat);
+    sendMembersList(address, JOINREP);
 }
 
 int MP1Node::indexInMembersList(MemberListEntry entry)
 {
-    for (int i = 0; i < memberNode->memberList.size(); i++)
-    {
-        if (memberNode->memberList[i].id == entry.id && memberNode->memberList[i].port == entry.port)
-            return i;
-    }
-    return -1;
+    return memberNode->indexOfMember(entry.id, entry.port);
 }
 
-void MP1Node::sendMembersList(Address address, enum MsgTypes msgType)
+/**
+ * FUNCTION NAME: logDebug
+ *
+ * DESCRIPTION: Debug message of the node, at LOG_LEVEL_DEBUG. The Log of the assignment
+ * 				harness has no levels and logs it as is.
+ */
+void MP1Node::logDebug(const char *str)
 {
-    size_t initSize = sizeof(short) + sizeof(address.addr) + sizeof(long);
+#ifdef STOCK_HARNESS
+    log->LOG(&memberNode->addr, str);
+#else
+    log->debug(&memberNode->addr, str);
+#endif
+}
+
+/**
+ * FUNCTION NAME: touch
+ *
+ * DESCRIPTION: Stamp a changed entry with the next local version so the delta gossip
+ * 				spreads it again
+ */
+void MP1Node::touch(MemberListEntry &entry)
+{
+    entry.version = ++version;
+}
 
-    char *msg = (char *)malloc(initSize * sizeof(char));
-    long temp = -1;
+/**
+ * FUNCTION NAME: sendMembersList
+ *
+ * DESCRIPTION: Send the membership list to address.
+ * 				The header carries the local version and the highest version of the
+ * 				receiver applied here. Gossip only carries the entries changed since the
+ * 				version the receiver acknowledged, except every GOSSIP_FULLSYNC ticks;
+ * 				JOINREP always carries the whole list.
+ * 				Format: type, sender address, then varints: version, ack, sender heartbeat,
+ * 				a flags byte, the number of entries and, with GOSSIP_BITMAP, one bit per
+ * 				entry telling whether its heartbeat follows. Entries are sorted by address
+ * 				and made of the id delta to the previous entry, the port and the zigzag
+ * 				distance of the heartbeat to the sender heartbeat.
+ */
+void MP1Node::sendMembersList(Address address, enum MsgTypes msgType)
+{
+    GossipPeer &peer = peers[address.getAddress()];
 
-    memcpy(msg, &msgType, sizeof(short));
-    memcpy(msg + sizeof(short), &memberNode->addr.addr, sizeof(address.addr));
-    memcpy(msg + sizeof(short) + sizeof(address.addr), &temp, sizeof(long));
+    long since = peer.acked;
+    bool full = (msgType == JOINREP || memberNode->heartbeat % GOSSIP_FULLSYNC == 0);
 
-    size_t size = initSize;
+    vector<MemberListEntry *> entries;
     for (int i = 0; i < memberNode->memberList.size(); i++)
     {
-        if (memberNode->heartbeat - memberNode->memberList[i].gettimestamp() > TFAIL)
+        MemberListEntry &entry = memberNode->memberList[i];
+        if (entry.suspicion >= PHI_SUSPECT)
+            continue;
+        if (!full && entry.version <= since)
             continue;
+        if (entryAddress(entry) == address)
+            continue;
+        entries.push_back(&entry);
+    }
+    sort(entries.begin(), entries.end(), [](const MemberListEntry *a, const MemberListEntry *b) {
+        return Member::memberKey(a->id, a->port) < Member::memberKey(b->id, b->port);
+    });
 
-        Address memberAddr;
-        memcpy(&memberAddr.addr[0], &memberNode->memberList[i].id, sizeof(int));
-        memcpy(&memberAddr.addr[4], &memberNode->memberList[i].port, sizeof(short));
+    // Entries the receiver acknowledged are only listed in a full sync, without heartbeat
+    bool bitmap = full && msgType != JOINREP;
+    unsigned char flags = (bitmap ? GOSSIP_BITMAP : 0);
 
-        if (strcmp(memberAddr.addr, address.addr) != 0)
+    string msg;
+    short type = msgType;
+    msg.append((char *)&type, sizeof(short));
+    msg.append(memberNode->addr.addr, sizeof(memberNode->addr.addr));
+    putVarint(msg, version);
+    putVarint(msg, peer.seen);
+    putVarint(msg, memberNode->heartbeat);
+    msg.push_back((char)flags);
+    putVarint(msg, entries.size());
+    if (bitmap)
+    {
+        string bits((entries.size() + 7) / 8, 0);
+        for (size_t i = 0; i < entries.size(); i++)
         {
-            msg = (char *)realloc(msg, size + sizeof(memberAddr.addr) + sizeof(long));
-            memcpy(msg + size, memberAddr.addr, sizeof(memberAddr.addr));
-            memcpy(msg + size + sizeof(memberAddr.addr), &memberNode->memberList[i].heartbeat, sizeof(long));
-            size += sizeof(memberAddr.addr) + sizeof(long);
+            if (entries[i]->version > since)
+                bits[i / 8] |= (1 << (i % 8));
         }
+        msg.append(bits);
     }
-    emulNet->ENsend(&memberNode->addr, &address, (char *)msg, size);
 
-    free(msg);
+    int prevId = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        putVarint(msg, entries[i]->id - prevId);
+        putVarint(msg, (unsigned short)entries[i]->port);
+        if (!bitmap || entries[i]->version > since)
+            putVarint(msg, zigzag(memberNode->heartbeat - entries[i]->heartbeat));
+        prevId = entries[i]->id;
+    }
+
+    emulNet->ENsend(&memberNode->addr, &address, &msg[0], msg.size());
 }
 
+/**
+ * FUNCTION NAME: updateMemberships
+ *
+ * DESCRIPTION: Decode a JOINREP or GOSSIPMSG message straight into the membership list
+ */
 void MP1Node::updateMemberships(char *data, int size)
 {
-    vector<MemberListEntry> msgMembersList = membersListMsgDecode(data, size);
-    for (int i = 0; i < msgMembersList.size(); i++)
+    Address sender;
+    unsigned long senderVersion, ack, senderHeartbeat, count;
+    int pos = sizeof(short) + sizeof(sender.addr);
+    if (pos + 1 > size)
+        return;
+    memcpy(&sender.addr, data + sizeof(short), sizeof(sender.addr));
+    if (!getVarint(data, size, pos, senderVersion) || !getVarint(data, size, pos, ack) || !getVarint(data, size, pos, senderHeartbeat) || pos >= size)
+        return;
+    unsigned char flags = data[pos++];
+    if (!getVarint(data, size, pos, count))
+        return;
+    char *bits = NULL;
+    if (flags & GOSSIP_BITMAP)
     {
-        int index = indexInMembersList(msgMembersList[i]);
+        bits = data + pos;
+        pos += (count + 7) / 8;
+        if (pos > size)
+            return;
+    }
+
+    // The message holds every change of the sender up to senderVersion not seen here yet
+    GossipPeer &peer = peers[sender.getAddress()];
+    peer.seen = max(peer.seen, (long)senderVersion);
+    peer.acked = max(peer.acked, (long)ack);
+
+    int id = 0;
+    for (unsigned long i = 0; i < count && pos < size; i++)
+    {
+        unsigned long delta, port, distance = 0;
+        bool hasHeartbeat = (bits == NULL || (bits[i / 8] & (1 << (i % 8))));
+        if (!getVarint(data, size, pos, delta) || !getVarint(data, size, pos, port))
+            return;
+        if (hasHeartbeat && !getVarint(data, size, pos, distance))
+            return;
+        id += delta;
+        long heartbeat = hasHeartbeat ? (long)senderHeartbeat - unzigzag(distance) : 0;
+
+        MemberListEntry entry(id, (short)port, heartbeat, memberNode->heartbeat);
+        Address address = entryAddress(entry);
+        int index = memberNode->indexOfMember(id, (short)port);
         if (index == -1)
         {
-            memberNode->memberList.push_back(msgMembersList[i]);
+            touch(entry);
+            memberNode->addMember(entry);
             memberNode->nnb++;
-            Address address;
-            memcpy(&address.addr[0], &msgMembersList[i].id, sizeof(int));
-            memcpy(&address.addr[4], &msgMembersList[i].port, sizeof(short));
             log->logNodeAdd(&memberNode->addr, &address);
+            detector.heartbeat(address.getAddress(), memberNode->heartbeat);
         }
         else
         {
-            if (memberNode->memberList[index].getheartbeat() < msgMembersList[i].getheartbeat() && memberNode->heartbeat - memberNode->memberList[index].gettimestamp() <= TFAIL)
+            MemberListEntry &known = memberNode->memberList[index];
+            // Suspected members are still fed, so the suspicion clears when they turn out alive
+            if (hasHeartbeat && known.getheartbeat() < heartbeat)
             {
-                memberNode->memberList[index].setheartbeat(msgMembersList[i].getheartbeat());
-                memberNode->memberList[index].settimestamp(memberNode->heartbeat);
+                known.setheartbeat(heartbeat);
+                known.settimestamp(memberNode->heartbeat);
+                detector.heartbeat(address.getAddress(), memberNode->heartbeat);
+                touch(known);
             }
         }
     }
 }
 
-vector<MemberListEntry> MP1Node::membersListMsgDecode(char *data, int size)
-{
-    vector<MemberListEntry> membersList;
-
-    size_t senderInfoPart = sizeof(short) + sizeof(memberNode->addr.addr) + sizeof(long);
-
-    Address joinAddr = getJoinAddress();
-    for (size_t i = senderInfoPart; i < size; i += (sizeof(joinAddr.addr) + sizeof(long)))
-    {
-        int id;
-        short port;
-        long heartbeat;
-        memcpy(&id, data + i, sizeof(int));
-        memcpy(&port, data + i + 4, sizeof(short));
-        memcpy(&heartbeat, data + i + sizeof(joinAddr.addr), sizeof(long));
-        MemberListEntry entry(id, port, heartbeat, memberNode->heartbeat);
-        membersList.push_back(entry);
-    }
-    return membersList;
-}
-
 /**
  * FUNCTION NAME: nodeLoopOps
  *
- * DESCRIPTION: Check if any node hasn't responded within a timeout period and then delete
+ * DESCRIPTION: Check if any node is suspected beyond PHI_REMOVE and then delete
  * 				the nodes
  * 				Propagate your membership list
  */
 void MP1Node::nodeLoopOps()
 {
+    gossipRounds->add();
+    refreshSuspicion();
+    if (membership == SWIM_MEMBERSHIP)
+    {
+        swimLoopOps();
+        return;
+    }
     deleteTimeoutedMembers();
     spreadGossip();
     return;
@@ -396,22 +538,30 @@ void MP1Node::deleteTimeoutedMembers()
 {
     vector<MemberListEntry> updatedList;
     updatedList.clear();
+    bool removed = false;
     for (int i = 0; i < memberNode->memberList.size(); i++)
     {
-        if (memberNode->heartbeat - memberNode->memberList[i].gettimestamp() >= TREMOVE)
+        if (memberNode->memberList[i].suspicion >= PHI_REMOVE)
         {
             memberNode->nnb--;
             Address memberAddr;
             memcpy(&memberAddr.addr[0], &memberNode->memberList[i].id, sizeof(int));
             memcpy(&memberAddr.addr[4], &memberNode->memberList[i].port, sizeof(short));
             log->logNodeRemove(&memberNode->addr, &memberAddr);
+            peers.erase(memberAddr.getAddress());
+            detector.remove(memberAddr.getAddress());
+            removed = true;
         }
         else
         {
             updatedList.push_back(memberNode->memberList[i]);
         }
     }
-    memberNode->memberList = updatedList;
+    if (removed)
+    {
+        memberNode->memberList = updatedList;
+        memberNode->reindexMembers();
+    }
 }
 
 void MP1Node::spreadGossip()
@@ -443,6 +593,388 @@ void MP1Node::spreadGossip()
         memcpy(&neighbour.addr[4], &infectedNeighbours[i].port, sizeof(short));
         sendMembersList(neighbour, GOSSIPMSG);
     }
+
+    // The introducer hears the whole list of everyone now and then, so the sides of a
+    // healed network partition, which removed each other, find each other again
+    Address joinaddr = getJoinAddress();
+    if (memberNode->heartbeat % GOSSIP_FULLSYNC == 0 && !(joinaddr == memberNode->addr))
+        sendMembersList(joinaddr, GOSSIPMSG);
+}
+
+/**
+ * FUNCTION NAME: refreshSuspicion
+ *
+ * DESCRIPTION: Update the suspicion level of every member.
+ * 				Gossip mode takes it from the phi accrual detector fed by the heartbeats,
+ * 				SWIM mode from the state of the member.
+ */
+void MP1Node::refreshSuspicion()
+{
+    for (size_t i = 0; i < memberNode->memberList.size(); i++)
+    {
+        MemberListEntry &entry = memberNode->memberList[i];
+        Address address = entryAddress(entry);
+        if (address == memberNode->addr)
+            entry.suspicion = 0;
+        else if (membership == SWIM_MEMBERSHIP)
+            entry.suspicion = (entry.state == MEMBER_SUSPECT ? PHI_SUSPECT : 0);
+        else
+            entry.suspicion = detector.phi(address.getAddress(), memberNode->heartbeat);
+    }
+}
+
+/**
+ * FUNCTION NAME: entryAddress
+ *
+ * DESCRIPTION: Address of the member of a membership list entry
+ */
+Address MP1Node::entryAddress(MemberListEntry &entry)
+{
+    Address address;
+    memcpy(&address.addr[0], &entry.id, sizeof(int));
+    memcpy(&address.addr[4], &entry.port, sizeof(short));
+    return address;
+}
+
+/**
+ * FUNCTION NAME: swimLoopOps
+ *
+ * DESCRIPTION: SWIM duties of a tick:
+ * 				1) Declare dead the members suspected for SWIM_SUSPECT_TIMEOUT
+ * 				2) Ask SWIM_K members to probe the target when the direct probe timed out
+ * 				3) Suspect the target when no ack came back within SWIM_PERIOD
+ * 				4) Start the probe of the next member once every SWIM_PERIOD
+ */
+void MP1Node::swimLoopOps()
+{
+    long now = memberNode->heartbeat;
+
+    vector<MemberListEntry> expired;
+    for (size_t i = 0; i < memberNode->memberList.size(); i++)
+    {
+        if (memberNode->memberList[i].state == MEMBER_SUSPECT && now - memberNode->memberList[i].gettimestamp() >= SWIM_SUSPECT_TIMEOUT)
+            expired.push_back(memberNode->memberList[i]);
+    }
+    for (size_t i = 0; i < expired.size(); i++)
+    {
+        swimApply(entryAddress(expired[i]), expired[i].incarnation, MEMBER_DEAD);
+    }
+
+    map<long, SwimRelay>::iterator it = relays.begin();
+    while (it != relays.end())
+    {
+        if (now - it->second.sentAt > SWIM_PERIOD)
+            relays.erase(it++);
+        else
+            it++;
+    }
+
+    if (probeActive && !probeIndirect && now - probeSentAt >= SWIM_PING_TIMEOUT)
+    {
+        vector<Address> helpers;
+        for (size_t i = 0; i < memberNode->memberList.size(); i++)
+        {
+            Address address = entryAddress(memberNode->memberList[i]);
+            if (!(address == memberNode->addr) && !(address == probeTarget))
+                helpers.push_back(address);
+        }
+        random_shuffle(helpers.begin(), helpers.end());
+        for (size_t i = 0; i < helpers.size() && i < SWIM_K; i++)
+        {
+            swimSend(helpers[i], PINGREQ, probeId, &probeTarget);
+        }
+        probeIndirect = true;
+    }
+
+    if (probeActive && now - probeSentAt >= SWIM_PERIOD)
+    {
+        probeActive = false;
+        MemberListEntry target(*(int *)(&probeTarget.addr[0]), *(short *)(&probeTarget.addr[4]));
+        int index = indexInMembersList(target);
+        if (index != -1 && memberNode->memberList[index].state == MEMBER_ALIVE)
+            swimApply(probeTarget, memberNode->memberList[index].incarnation, MEMBER_SUSPECT);
+    }
+
+    if (!probeActive && now - probeSentAt >= SWIM_PERIOD)
+    {
+        swimProbe();
+    }
+}
+
+/**
+ * FUNCTION NAME: swimProbe
+ *
+ * DESCRIPTION: Ping the next member. Members are probed round-robin in an order
+ * 				shuffled again on every round.
+ */
+void MP1Node::swimProbe()
+{
+    while (true)
+    {
+        if (probeIndex >= probeOrder.size())
+        {
+            probeOrder.clear();
+            for (size_t i = 0; i < memberNode->memberList.size(); i++)
+            {
+                Address address = entryAddress(memberNode->memberList[i]);
+                if (!(address == memberNode->addr))
+                    probeOrder.push_back(address);
+            }
+            random_shuffle(probeOrder.begin(), probeOrder.end());
+            probeIndex = 0;
+            if (probeOrder.empty())
+                return;
+        }
+        Address target = probeOrder[probeIndex++];
+        MemberListEntry entry(*(int *)(&target.addr[0]), *(short *)(&target.addr[4]));
+        if (indexInMembersList(entry) != -1)
+        {
+            probeTarget = target;
+            break;
+        }
+    }
+
+    probeId = ++seq;
+    probeSentAt = memberNode->heartbeat;
+    probeActive = true;
+    probeIndirect = false;
+    swimSend(probeTarget, PING, probeId, NULL);
+}
+
+/**
+ * FUNCTION NAME: swimSend
+ *
+ * DESCRIPTION: Send a SWIM message with the updates piggybacked on it.
+ * 				Format: type, sender, seq, target, number of updates, then for every update
+ * 				the address, the incarnation and the state.
+ * 				JOINREP carries the whole membership list instead of the pending updates.
+ */
+void MP1Node::swimSend(Address to, enum MsgTypes msgType, long seq, Address *target)
+{
+    vector<SwimUpdate> carried;
+    if (msgType == JOINREP)
+    {
+        for (size_t i = 0; i < memberNode->memberList.size(); i++)
+        {
+            SwimUpdate update;
+            update.addr = entryAddress(memberNode->memberList[i]);
+            update.incarnation = memberNode->memberList[i].incarnation;
+            update.state = memberNode->memberList[i].state;
+            if (update.addr == memberNode->addr)
+                update.incarnation = incarnation;
+            carried.push_back(update);
+        }
+    }
+    else
+    {
+        // The least sent updates first
+        sort(updates.begin(), updates.end(), [](const SwimUpdate &a, const SwimUpdate &b) { return a.sent < b.sent; });
+        int limit = SWIM_RETRANSMIT * (int)ceil(log2(memberNode->memberList.size() + 1));
+        for (size_t i = 0; i < updates.size() && carried.size() < SWIM_PIGGYBACK; i++)
+        {
+            updates[i].sent++;
+            carried.push_back(updates[i]);
+        }
+        vector<SwimUpdate> pending;
+        for (size_t i = 0; i < updates.size(); i++)
+        {
+            if (updates[i].sent < limit)
+                pending.push_back(updates[i]);
+        }
+        updates = pending;
+    }
+
+    size_t recordSize = sizeof(to.addr) + sizeof(int) + sizeof(char);
+    size_t headerSize = sizeof(short) + 2 * sizeof(to.addr) + sizeof(long) + sizeof(short);
+    size_t size = headerSize + carried.size() * recordSize;
+    char *msg = (char *)malloc(size * sizeof(char));
+
+    short type = msgType;
+    short count = carried.size();
+    char *p = msg;
+    memcpy(p, &type, sizeof(short));
+    p += sizeof(short);
+    memcpy(p, &memberNode->addr.addr, sizeof(to.addr));
+    p += sizeof(to.addr);
+    memcpy(p, &seq, sizeof(long));
+    p += sizeof(long);
+    if (target != NULL)
+        memcpy(p, &target->addr, sizeof(to.addr));
+    else
+        memcpy(p, NULLADDR, sizeof(to.addr));
+    p += sizeof(to.addr);
+    memcpy(p, &count, sizeof(short));
+    p += sizeof(short);
+    for (size_t i = 0; i < carried.size(); i++)
+    {
+        char state = carried[i].state;
+        memcpy(p, &carried[i].addr.addr, sizeof(to.addr));
+        memcpy(p + sizeof(to.addr), &carried[i].incarnation, sizeof(int));
+        memcpy(p + sizeof(to.addr) + sizeof(int), &state, sizeof(char));
+        p += recordSize;
+    }
+
+    emulNet->ENsend(&memberNode->addr, &to, msg, size);
+
+    free(msg);
+}
+
+/**
+ * FUNCTION NAME: swimHandle
+ *
+ * DESCRIPTION: Apply the piggybacked updates of a SWIM message, then:
+ * 				JOINREP: join the group
+ * 				PING: ack it
+ * 				PINGREQ: probe the target on behalf of the sender
+ * 				ACK: relay it to the requester, or end the current probe
+ */
+void MP1Node::swimHandle(char *data, int size, short type)
+{
+    Address from, target;
+    long msgSeq;
+    short count;
+    int recordSize = sizeof(from.addr) + sizeof(int) + sizeof(char);
+    int headerSize = sizeof(short) + 2 * sizeof(from.addr) + sizeof(long) + sizeof(short);
+    if (size < headerSize)
+        return;
+
+    char *p = data + sizeof(short);
+    memcpy(&from.addr, p, sizeof(from.addr));
+    p += sizeof(from.addr);
+    memcpy(&msgSeq, p, sizeof(long));
+    p += sizeof(long);
+    memcpy(&target.addr, p, sizeof(target.addr));
+    p += sizeof(target.addr);
+    memcpy(&count, p, sizeof(short));
+    p += sizeof(short);
+
+    for (int i = 0; i < count && headerSize + (i + 1) * recordSize <= size; i++)
+    {
+        Address address;
+        int inc;
+        char state;
+        memcpy(&address.addr, p, sizeof(address.addr));
+        memcpy(&inc, p + sizeof(address.addr), sizeof(int));
+        memcpy(&state, p + sizeof(address.addr) + sizeof(int), sizeof(char));
+        p += recordSize;
+        swimApply(address, inc, state);
+    }
+
+    if (type == JOINREP)
+    {
+        memberNode->inGroup = true;
+    }
+    else if (type == PING)
+    {
+        swimSend(from, ACK, msgSeq, NULL);
+    }
+    else if (type == PINGREQ)
+    {
+        SwimRelay relay;
+        relay.requester = from;
+        relay.seq = msgSeq;
+        relay.sentAt = memberNode->heartbeat;
+        relays[++seq] = relay;
+        swimSend(target, PING, seq, NULL);
+    }
+    else if (type == ACK)
+    {
+        map<long, SwimRelay>::iterator search = relays.find(msgSeq);
+        if (search != relays.end())
+        {
+            swimSend(search->second.requester, ACK, search->second.seq, NULL);
+            relays.erase(search);
+        }
+        else if (probeActive && msgSeq == probeId)
+        {
+            probeActive = false;
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: swimApply
+ *
+ * DESCRIPTION: Merge a membership update into the list and spread it if it changed
+ * 				anything. An alive update overrides older incarnations, a suspect update
+ * 				overrides the same incarnation alive, a dead update overrides everything.
+ * 				Suspicions about this node are refuted with a new incarnation.
+ */
+void MP1Node::swimApply(Address addr, int inc, int state)
+{
+    if (addr == memberNode->addr)
+    {
+        if (state != MEMBER_ALIVE && inc >= incarnation)
+        {
+            incarnation = inc + 1;
+            swimGossip(memberNode->addr, incarnation, MEMBER_ALIVE);
+        }
+        return;
+    }
+
+    string key = addr.getAddress();
+    map<string, int>::iterator search = dead.find(key);
+    if (search != dead.end() && (state == MEMBER_DEAD || inc <= search->second))
+        return;
+
+    MemberListEntry entry(*(int *)(&addr.addr[0]), *(short *)(&addr.addr[4]), 0, memberNode->heartbeat);
+    int index = indexInMembersList(entry);
+    if (index == -1)
+    {
+        if (state == MEMBER_DEAD)
+        {
+            dead[key] = inc;
+            return;
+        }
+        entry.incarnation = inc;
+        entry.state = state;
+        memberNode->addMember(entry);
+        memberNode->nnb++;
+        log->logNodeAdd(&memberNode->addr, &addr);
+        swimGossip(addr, inc, state);
+        return;
+    }
+
+    MemberListEntry &known = memberNode->memberList[index];
+    if (state == MEMBER_DEAD)
+    {
+        memberNode->removeMember(index);
+        memberNode->nnb--;
+        log->logNodeRemove(&memberNode->addr, &addr);
+        dead[key] = inc;
+        swimGossip(addr, inc, state);
+    }
+    else if ((state == MEMBER_ALIVE && inc > known.incarnation) ||
+             (state == MEMBER_SUSPECT && (inc > known.incarnation || (inc == known.incarnation && known.state == MEMBER_ALIVE))))
+    {
+        known.incarnation = inc;
+        known.state = state;
+        known.settimestamp(memberNode->heartbeat);
+        swimGossip(addr, inc, state);
+    }
+}
+
+/**
+ * FUNCTION NAME: swimGossip
+ *
+ * DESCRIPTION: Queue an update for piggybacking, replacing the pending update of the same member
+ */
+void MP1Node::swimGossip(Address addr, int inc, int state)
+{
+    SwimUpdate update;
+    update.addr = addr;
+    update.incarnation = inc;
+    update.state = state;
+    update.sent = 0;
+    for (size_t i = 0; i < updates.size(); i++)
+    {
+        if (updates[i].addr == addr)
+        {
+            updates[i] = update;
+            return;
+        }
+    }
+    updates.push_back(update);
 }
 
 /**
@@ -479,12 +1011,13 @@ Address MP1Node::getJoinAddress()
 void MP1Node::initMemberListTable(Member *memberNode)
 {
     memberNode->memberList.clear();
+    memberNode->memberIndex.clear();
     int id;
     short port;
     memcpy(&id, &memberNode->addr.addr[0], sizeof(int));
-    memcpy(&port, &memberNode->addr.addr[1], sizeof(short));
+    memcpy(&port, &memberNode->addr.addr[4], sizeof(short));
     MemberListEntry selfEntry(id, port, memberNode->heartbeat, memberNode->heartbeat);
-    memberNode->memberList.push_back(selfEntry);
+    memberNode->addMember(selfEntry);
 }
 
 /**
@@ -12,15 +12,32 @@
 #include "Log.h"
 #include "Params.h"
 #include "Member.h"
-#include "EmulNet.h"
+#include "common.h"
+#include "Transport.h"
 #include "Queue.h"
+#include "FailureDetector.h"
+#include "Varint.h"
+#include "Metrics.h"
+#include "Trace.h"
 
 /**
  * Macros
  */
-#define TREMOVE 20
 #define TFAIL 10
 #define GOSSIPLIMIT 3
+// every GOSSIP_FULLSYNC ticks the whole list is gossiped instead of the delta
+#define GOSSIP_FULLSYNC 10
+// gossip flag: a bitmap tells which entries carry a heartbeat
+#define GOSSIP_BITMAP 0x01
+// SWIM: ticks between two probes, ticks before a probe goes indirect, members asked to
+// probe indirectly and ticks a member stays suspected before it is declared dead
+#define SWIM_PERIOD 7
+#define SWIM_PING_TIMEOUT 2
+#define SWIM_K 3
+#define SWIM_SUSPECT_TIMEOUT 10
+// SWIM: updates piggybacked per message, every update being sent SWIM_RETRANSMIT * log2(N) times
+#define SWIM_PIGGYBACK 8
+#define SWIM_RETRANSMIT 3
 
 /*
  * Note: You can change/add any functions in MP1Node.{h,cpp}
@@ -34,6 +51,9 @@ enum MsgTypes
 	JOINREQ,
 	JOINREP,
 	GOSSIPMSG,
+	PING,
+	PINGREQ,
+	ACK,
 	DUMMYLASTMSGTYPE
 };
 
@@ -47,6 +67,46 @@ typedef struct MessageHdr
 	enum MsgTypes msgType;
 } MessageHdr;
 
+/**
+ * STRUCT NAME: GossipPeer
+ *
+ * DESCRIPTION: Delta gossip state of a peer
+ */
+typedef struct GossipPeer
+{
+	// highest version of this node the peer is known to have applied
+	long acked;
+	// highest version of the peer this node has applied
+	long seen;
+	GossipPeer(): acked(0), seen(0) {}
+} GossipPeer;
+
+/**
+ * STRUCT NAME: SwimUpdate
+ *
+ * DESCRIPTION: Membership update waiting to be piggybacked on SWIM messages
+ */
+typedef struct SwimUpdate
+{
+	Address addr;
+	int incarnation;
+	int state;
+	// number of messages that carried it
+	int sent;
+} SwimUpdate;
+
+/**
+ * STRUCT NAME: SwimRelay
+ *
+ * DESCRIPTION: Probe sent on behalf of the member that asked for it with a PINGREQ
+ */
+typedef struct SwimRelay
+{
+	Address requester;
+	long seq;
+	long sentAt;
+} SwimRelay;
+
 /**
  * CLASS NAME: MP1Node
  *
@@ -55,14 +115,46 @@ typedef struct MessageHdr
 class MP1Node
 {
 private:
-	EmulNet *emulNet;
+	Transport *emulNet;
 	Log *log;
 	Params *par;
 	Member *memberNode;
 	char NULLADDR[6];
+	// membership protocol run, gossip or SWIM
+	int membership;
+	// version counter of the local changes to the membership list
+	long version;
+	map<string, GossipPeer> peers;
+	FailureDetector detector;
+	// protocol periods run, gossip or SWIM
+	Counter *gossipRounds;
+	void touch(MemberListEntry &entry);
+	void refreshSuspicion();
+	void logDebug(const char *str);
+	// SWIM state
+	int incarnation;
+	long seq;
+	long probeId;
+	Address probeTarget;
+	long probeSentAt;
+	bool probeActive;
+	bool probeIndirect;
+	vector<Address> probeOrder;
+	size_t probeIndex;
+	map<long, SwimRelay> relays;
+	vector<SwimUpdate> updates;
+	// incarnation of the members declared dead, so stale updates do not bring them back
+	map<string, int> dead;
+	Address entryAddress(MemberListEntry &entry);
+	void swimLoopOps();
+	void swimProbe();
+	void swimSend(Address to, enum MsgTypes msgType, long seq, Address *target);
+	void swimHandle(char *data, int size, short type);
+	void swimApply(Address addr, int incarnation, int state);
+	void swimGossip(Address addr, int incarnation, int state);
 
 public:
-	MP1Node(Member *, Params *, EmulNet *, Log *, Address *);
+	MP1Node(Member *, Params *, Transport *, Log *, Address *);
 	Member *getMemberNode()
 	{
 		return memberNode;
@@ -76,11 +168,10 @@ public:
 	void nodeLoop();
 	void checkMessages();
 	bool recvCallBack(void *env, char *data, int size);
-	void addMemberToList(Address address, long heartbeat);
+	void addMemberToList(Address address, long heartbeat, int incarnation = 0);
 	int indexInMembersList(MemberListEntry entry);
 	void sendMembersList(Address address, enum MsgTypes msgType = GOSSIPMSG);
 	void updateMemberships(char *data, int size);
-	vector<MemberListEntry> membersListMsgDecode(char *data, int size);
 	void deleteTimeoutedMembers();
 	void spreadGossip();
 	void nodeLoopOps();
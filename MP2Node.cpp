@@ -5,55 +5,130 @@
  **********************************/
 #include "MP2Node.h"
 
+// Transaction Id
+int g_transID = 0;
+
 /**
  * constructor
  */
-MP2Node::MP2Node(Member *memberNode, Params *par, EmulNet * emulNet, Log * log, Address * address) {
+MP2Node::MP2Node(Member *memberNode, Params *par, Transport * emulNet, Log * log, Address * address) {
 	this->memberNode = memberNode;
 	this->par = par;
 	this->emulNet = emulNet;
 	this->log = log;
 	ht = new HashTable();
 	this->memberNode->addr = *address;
+	this->nextStreamID = 0;
+	this->rejoinRounds = 0;
+	this->rejoinSentAt = 0;
+	this->oldestOpen = 0;
+	this->ringEpoch = -1;
+#ifdef STOCK_HARNESS
+	// the Params of the assignment harness have none of the options of the store
+	this->partitioner = Partitioner::create(RING_PARTITIONER);
+	this->statsPeriod = 0;
+	this->rebalancePeriod = 0;
+#else
+	this->partitioner = Partitioner::create(par->PARTITIONER);
+	map<int, double>::iterator weight;
+	for ( weight = par->NODE_WEIGHTS.begin(); weight != par->NODE_WEIGHTS.end(); weight++ ) {
+		this->partitioner->setWeight(weight->first, weight->second);
+	}
+	this->statsPeriod = par->STATS_PERIOD;
+	this->rebalancePeriod = par->REBALANCE;
+#endif
+	string labels = "node=\"" + address->getAddress() + "\"";
+	storeKeys = metrics().gauge("kv_store_keys", "Keys held by the node.", labels);
+	storeBytes = metrics().gauge("kv_store_bytes", "Bytes of the keys and values held by the node.", labels);
+	openTransactions = metrics().gauge("kv_transactions_open", "Transactions of the node waiting for their outcome.", labels);
+	stabilizationKeys = metrics().counter("kv_stabilization_keys_total", "Keys streamed to other replicas by the stabilization protocol.", labels);
+	stabilizationBytes = metrics().counter("kv_stabilization_bytes_total", "Bytes of the range stream chunks sent, resends included.", labels);
 }
 
 /**
  * Destructor
  */
 MP2Node::~MP2Node() {
+	for ( size_t i = 0; i < transactions.size(); i++ ) {
+		delete transactions[i];
+	}
 	delete ht;
+	delete partitioner;
 	delete memberNode;
 }
 
+/**
+ * FUNCTION NAME: restart
+ *
+ * DESCRIPTION: Come back from a crash with the state of a new node: the store, the ring,
+ * 				the batched messages and the range transfers are lost. The ring is rebuilt
+ * 				from the membership list once the node joined again, and the open transactions
+ * 				time out. The ring is then asked for the partitions of the node, see rejoinLoop.
+ */
+void MP2Node::restart() {
+	delete ht;
+	ht = new HashTable();
+	ring.clear();
+	ringEpoch = -1;
+	partitionMap = PartitionMap();
+	outbox.clear();
+	outStreams.clear();
+	inStreams.clear();
+	rejoinRounds = STREAM_RETRIES + 1;
+	rejoinSentAt = par->getcurrtime() - STREAM_TIMEOUT;
+	rejoinHeard.clear();
+	handedOver.clear();
+}
+
 /**
  * FUNCTION NAME: updateRing
  *
  * DESCRIPTION: This function does the following:
- * 				1) Gets the current membership list from the Membership Protocol (MP1Node)
- * 				   The membership list is returned as a vector of Nodes. See Node class in Node.h
- * 				2) Constructs the ring based on the membership list
- * 				3) Calls the Stabilization Protocol
+ * 				1) Returns at once if the membership epoch of MP1Node did not change
+ * 				2) Drops the nodes that left the membership list from the ring and inserts the
+ * 				   new ones at their position, hashing only those. Suspected members stay until
+ * 				   they are removed, so a short-lived suspicion does not move partitions.
+ * 				3) Calls the Stabilization Protocol if the ring changed
  */
 void MP2Node::updateRing() {
-	vector<Node> curMemList;
-	bool change = false;
-
-	curMemList = getMembershipList();
+	if ( memberNode->epoch == ringEpoch ) {
+		return;
+	}
+	TraceSpan span("MP2Node::updateRing", &memberNode->addr);
+	ringEpoch = memberNode->epoch;
 
-	sort(curMemList.begin(), curMemList.end());
+	unordered_map<long, Address> members;
+	for ( unsigned int i = 0; i < memberNode->memberList.size(); i++ ) {
+		MemberListEntry &entry = memberNode->memberList[i];
+		Address address;
+		memcpy(&address.addr[0], &entry.id, sizeof(int));
+		memcpy(&address.addr[4], &entry.port, sizeof(short));
+		members[Member::memberKey(entry.id, entry.port)] = address;
+	}
 
 	bool ringChanged = false;
-	if(ring.size() != curMemList.size()) {
-		ringChanged = true;
-	} else {
-		for(int i=0;i<curMemList.size();i++) {
-			ringChanged = ringChanged || (curMemList[i].getHashCode() != ring[i].getHashCode());
+	vector<Node> kept;
+	for ( unsigned int i = 0; i < ring.size(); i++ ) {
+		Address *address = ring[i].getAddress();
+		long key = Member::memberKey(*(int *)(&address->addr[0]), *(short *)(&address->addr[4]));
+		if ( members.erase(key) ) {
+			kept.push_back(ring[i]);
+		}
+		else {
+			ringChanged = true;
 		}
 	}
+	unordered_map<long, Address>::iterator it;
+	for ( it = members.begin(); it != members.end(); it++ ) {
+		Node node(it->second);
+		kept.insert(upper_bound(kept.begin(), kept.end(), node), node);
+		ringChanged = true;
+	}
 
 	if( ringChanged ) {
-		this->ring = curMemList;
-		this->stabilizationProtocol();
+		this->ring = kept;
+		this->partitioner->setNodes(ring);
+		this->applyPlacement();
 	}
 }
 
@@ -91,16 +166,19 @@ vector<Node> MP2Node::getMembershipList() {
  * size_t position on the ring
  */
 size_t MP2Node::hashFunction(string key) {
-	std::hash<string> hashFunc;
-	size_t ret = hashFunc(key);
+	size_t ret = hash64(key.data(), key.size());
 	return ret%RING_SIZE;
 }
 
-Message MP2Node::dispatchMessage(MessageType msgType, string key, string value) {
+Message MP2Node::dispatchMessage(MessageType msgType, int replicas, string key, string value) {
 	int created_at = this->par->getcurrtime();
 	int trans_id = this->transactions.size();
-	Transaction* t = new Transaction(trans_id, msgType, key, value, created_at);
+	Transaction* t = new Transaction(trans_id, msgType, key, value, created_at, replicas);
 	this->transactions.push_back(t);
+	openTransactions->add(1);
+	if ( clientTrace().isOpen() ) {
+		clientTrace().record(created_at, &this->memberNode->addr, msgType, key, value);
+	}
 	if(msgType == MessageType::CREATE || msgType == MessageType::UPDATE){
 		Message msg = Message(trans_id, this->memberNode->addr, msgType, key, value);
 		return msg;
@@ -121,10 +199,10 @@ Message MP2Node::dispatchMessage(MessageType msgType, string key, string value)
  * 				3) Sends a message to the replica
  */
 void MP2Node::clientCreate(string key, string value) {
-	vector<Node> replicas = findNodes(key);
-	string msg = (dispatchMessage(MessageType::CREATE, key, value)).toString();
+	vector<Node> replicas = contactedReplicas(key);
+	string msg = (dispatchMessage(MessageType::CREATE, replicas.size(), key, value)).toString();
 	for(int i=0;i<replicas.size();i++) {
-		this->emulNet->ENsend(&memberNode->addr, replicas[i].getAddress(), msg);
+		this->sendMessage(replicas[i].getAddress(), msg);
 	}
 }
 
@@ -138,10 +216,10 @@ void MP2Node::clientCreate(string key, string value) {
  * 				3) Sends a message to the replica
  */
 void MP2Node::clientRead(string key){
-	vector<Node> replicas = findNodes(key);
-	string msg = (dispatchMessage(MessageType::READ, key)).toString();
+	vector<Node> replicas = contactedReplicas(key);
+	string msg = (dispatchMessage(MessageType::READ, replicas.size(), key)).toString();
 	for(int i=0;i<replicas.size();i++) {
-		this->emulNet->ENsend(&memberNode->addr, replicas[i].getAddress(), msg);
+		this->sendMessage(replicas[i].getAddress(), msg);
 	}
 }
 
@@ -155,10 +233,10 @@ void MP2Node::clientRead(string key){
  * 				3) Sends a message to the replica
  */
 void MP2Node::clientUpdate(string key, string value){
-	vector<Node> replicas = findNodes(key);
-	string msg = (dispatchMessage(MessageType::UPDATE, key, value)).toString();
+	vector<Node> replicas = contactedReplicas(key);
+	string msg = (dispatchMessage(MessageType::UPDATE, replicas.size(), key, value)).toString();
 	for(int i=0;i<replicas.size();i++) {
-		this->emulNet->ENsend(&memberNode->addr, replicas[i].getAddress(), msg);
+		this->sendMessage(replicas[i].getAddress(), msg);
 	}
 }
 
@@ -172,10 +250,10 @@ void MP2Node::clientUpdate(string key, string value){
  * 				3) Sends a message to the replica
  */
 void MP2Node::clientDelete(string key){
-	vector<Node> replicas = findNodes(key);
-	string msg = (dispatchMessage(MessageType::DELETE, key)).toString();
+	vector<Node> replicas = contactedReplicas(key);
+	string msg = (dispatchMessage(MessageType::DELETE, replicas.size(), key)).toString();
 	for(int i=0;i<replicas.size();i++) {
-		this->emulNet->ENsend(&memberNode->addr, replicas[i].getAddress(), msg);
+		this->sendMessage(replicas[i].getAddress(), msg);
 	}
 }
 
@@ -188,13 +266,18 @@ void MP2Node::clientDelete(string key){
  * 			   	2) Return true or false based on success or failure
  */
 bool MP2Node::createKeyValue(string key, string value, ReplicaType replica, int transID, MessageType msgType) {
+	TraceSpan span("store.create", &memberNode->addr);
 	if( msgType == MessageType::STABILIZATION ) {
 		if( this->ht->read(key) != "" ) {
 			this->ht->deleteKey(key);
 		}
 		return this->ht->create(key, value);
 	} else {
-		bool result = this->ht->create(key, value);
+		// a key the range streams could not carry would never get to new replicas
+		bool result = RangeStream::fits(key, value, par->MAX_MSG_SIZE - BATCH_HEADROOM - STREAM_HEADROOM) && this->ht->create(key, value);
+		if( result ) {
+			this->ht->markChanged(key, par->getcurrtime());
+		}
 		if( result ) {
 			this->log->logCreateSuccess(&memberNode->addr, false, transID, key, value);
 		} else {
@@ -213,6 +296,7 @@ bool MP2Node::createKeyValue(string key, string value, ReplicaType replica, int
  * 			    2) Return value
  */
 string MP2Node::readKey(string key, int transID) {
+	TraceSpan span("store.read", &memberNode->addr);
 	string value = this->ht->read(key);
 	if(value != "") {
 		this->log->logReadSuccess(&memberNode->addr, false, transID, key, value);
@@ -231,7 +315,11 @@ string MP2Node::readKey(string key, int transID) {
  * 				2) Return true or false based on success or failure
  */
 bool MP2Node::updateKeyValue(string key, string value, ReplicaType replica, int transID) {
-	bool result = this->ht->update(key,value);
+	TraceSpan span("store.update", &memberNode->addr);
+	bool result = RangeStream::fits(key, value, par->MAX_MSG_SIZE - BATCH_HEADROOM - STREAM_HEADROOM) && this->ht->update(key,value);
+	if ( result ) {
+		this->ht->markChanged(key, par->getcurrtime());
+	}
 	if (result) {
 		this->log->logUpdateSuccess(&memberNode->addr, false, transID, key, value);
 	} else {
@@ -249,6 +337,9 @@ bool MP2Node::updateKeyValue(string key, string value, ReplicaType replica, int
  * 				2) Return true or false based on success or failure
  */
 bool MP2Node::deletekey(string key, int transID) {
+	TraceSpan span("store.delete", &memberNode->addr);
+	// also when the key is missing, so that a stream does not bring it back
+	this->ht->markChanged(key, par->getcurrtime());
 	bool result = this->ht->deleteKey(key);
 	if ( transID == -1 ) {
 		return result;
@@ -270,6 +361,7 @@ bool MP2Node::deletekey(string key, int transID) {
  * 				2) Handles the messages according to message types
  */
 void MP2Node::checkMessages() {
+	TraceSpan span("MP2Node::checkMessages", &memberNode->addr);
 	char * data;
 	int size;
 
@@ -278,36 +370,144 @@ void MP2Node::checkMessages() {
 		size = memberNode->mp2q.front().size;
 		memberNode->mp2q.pop();
 
-		string message(data, data + size);
-		Message msg = Message(message);
-
-		switch( msg.type ) {
-			case MessageType::STABILIZATION:
-			case MessageType::CREATE:
-			case MessageType::DELETE:
-			case MessageType::READ:
-			case MessageType::UPDATE: {
-				this->createTransaction(msg);
-				break;
+		if ( MessageBatch::isBatch(data, size) ) {
+			vector<string> messages = MessageBatch::unpack(data, size);
+			for ( size_t i = 0; i < messages.size(); i++ ) {
+				this->handleMessage(Message(messages[i]));
 			}
+		}
+		else {
+			string message(data, data + size);
+			this->handleMessage(Message(message));
+		}
+	}
 
-			case MessageType::REPLY:
-			case MessageType::READREPLY: {
-				this->updateTransaction(msg);
-				break;
-			}
 
+	// Transactions are created in time order, so the scan for timeouts starts at the oldest
+	// open one, freeing the finished ones before it, and stops at the first one still in time
+	for(size_t i=this->oldestOpen;i < this->transactions.size();i++) {
+		Transaction *t = this->transactions[i];
+		if(t == NULL || t->isFinished) {
+			if(i == this->oldestOpen) {
+				delete t;
+				this->transactions[i] = NULL;
+				this->oldestOpen++;
+			}
+			continue;
+		}
+		if(this->par->getcurrtime() - t->created_at <= 15) {
+			break;
+		}
+		bool success = false;
+		if(t->successReply >= 2) {
+			success = true;
 		}
+		logTransaction(t, success);
 	}
 
+	// chunks read before then are refused, so the writes they could undo are not needed
+	ht->forgetChanges(par->getcurrtime() - STREAM_MAX_AGE);
+	storeKeys->set(ht->currentSize());
+	storeBytes->set(ht->currentBytes());
+	if ( statsPeriod && par->getcurrtime() % statsPeriod == 0 ) {
+		stats.report(log, &memberNode->addr, par->getcurrtime());
+	}
 
-	for(int i=0;i < this->transactions.size();i++) {
-		if(this->transactions[i] != NULL && this->transactions[i]->isFinished == false && this->par->getcurrtime() - this->transactions[i]->created_at > 15) {
-			bool success = false;
-			if(this->transactions[i]->successReply >= 2) {
-				success = true;
+	this->rebalanceLoop();
+	this->rejoinLoop();
+	this->dropHandedOver();
+	this->sendStreams();
+	this->flushMessages();
+}
+
+/**
+ * FUNCTION NAME: handleMessage
+ *
+ * DESCRIPTION: Handle a single message according to its type
+ */
+void MP2Node::handleMessage(Message msg) {
+	switch( msg.type ) {
+		case MessageType::STABILIZATION:
+		case MessageType::CREATE:
+		case MessageType::DELETE:
+		case MessageType::READ:
+		case MessageType::UPDATE: {
+			if ( rebalancePeriod && msg.transID != -1 && msg.type != MessageType::STABILIZATION ) {
+				rebalancer.countRequest(HashTable::partitionOf(msg.key));
 			}
-			logTransaction(this->transactions[i], success);
+			this->createTransaction(msg);
+			break;
+		}
+
+		case MessageType::REPLY:
+		case MessageType::READREPLY: {
+			this->updateTransaction(msg);
+			break;
+		}
+
+		case MessageType::STREAMDATA: {
+			this->handleStreamData(msg);
+			break;
+		}
+
+		case MessageType::STREAMACK: {
+			this->handleStreamAck(msg);
+			break;
+		}
+
+		case MessageType::LOADREPORT: {
+			rebalancer.receiveReport(msg.fromAddr.getAddress(), msg.value, par->getcurrtime());
+			break;
+		}
+
+		case MessageType::REBALANCE: {
+			if ( rebalancer.applyMoves(msg.transID, msg.value) ) {
+				this->applyPlacement();
+			}
+			break;
+		}
+
+		case MessageType::REJOIN: {
+			this->handleRejoin(msg.fromAddr);
+			break;
+		}
+
+	}
+}
+
+/**
+ * FUNCTION NAME: sendMessage
+ *
+ * DESCRIPTION: Queue a message in the batch of its destination.
+ * 				Everything queued is sent by the next flushMessages.
+ */
+void MP2Node::sendMessage(Address *toAddr, string message) {
+	string to = toAddr->getAddress();
+	map<string, MessageBatch>::iterator search = outbox.find(to);
+	if ( search == outbox.end() ) {
+		search = outbox.insert(make_pair(to, MessageBatch(*toAddr, par->MAX_MSG_SIZE - BATCH_HEADROOM))).first;
+	}
+	search->second.append(message);
+}
+
+/**
+ * FUNCTION NAME: flushMessages
+ *
+ * DESCRIPTION: Send the frames of every destination batch. The messages of a failed
+ * 				node are dropped.
+ */
+void MP2Node::flushMessages() {
+	map<string, MessageBatch>::iterator it;
+	for ( it = outbox.begin(); it != outbox.end(); it++ ) {
+		if ( it->second.empty() ) {
+			continue;
+		}
+		vector<string> frames = it->second.takeFrames();
+		if ( memberNode->bFailed ) {
+			continue;
+		}
+		for ( size_t i = 0; i < frames.size(); i++ ) {
+			emulNet->ENsend(&memberNode->addr, &it->second.to, frames[i]);
 		}
 	}
 }
@@ -315,6 +515,7 @@ void MP2Node::checkMessages() {
 void MP2Node::createTransaction(Message msg) {
 	Message reply = Message(msg);
 	bool result;
+	unsigned long start = Stats::now();
 	switch( msg.type ) {
 		case MessageType::READ: {
 			string value = this->readKey(msg.key, msg.transID);
@@ -338,8 +539,14 @@ void MP2Node::createTransaction(Message msg) {
 			reply = Message(msg.transID, this->memberNode->addr, MessageType::REPLY, result);
 			break;
 		}
+		default:
+			// replies and the messages of the streams and of the rebalancer are not requests
+			return;
+	}
+	if ( msg.type != MessageType::STABILIZATION && msg.transID != -1 ) {
+		stats.record(REPLICA_ROLE, msg.type, result, Stats::now() - start);
 	}
-	this->emulNet->ENsend(&memberNode->addr, &msg.fromAddr, reply.toString());
+	this->sendMessage(&msg.fromAddr, reply.toString());
 
 }
 
@@ -359,7 +566,7 @@ void MP2Node::updateTransaction(Message msg) {
 		t->successReply++;
 	}
 
-	if( t->allReply == 3 ) {
+	if( t->allReply == t->replicas ) {
 		if( t->successReply >= 2 ) {
 			this->logTransaction(t, true);
 		} else {
@@ -370,6 +577,8 @@ void MP2Node::updateTransaction(Message msg) {
 
 void MP2Node::logTransaction(Transaction* t, bool success) {
 	t->isFinished = true;
+	openTransactions->add(-1);
+	stats.record(COORDINATOR_ROLE, t->type, success, Stats::now() - t->started_at);
 	switch (t->type) {
 		case CREATE: {
 			if (success) {
@@ -406,6 +615,9 @@ void MP2Node::logTransaction(Transaction* t, bool success) {
 			}
 			break;
 		}
+
+		default:
+			break;
 	}
 }
 
@@ -414,43 +626,47 @@ void MP2Node::logTransaction(Transaction* t, bool success) {
  *
  * DESCRIPTION: Find the replicas of the given keyfunction
  * 				This function is responsible for finding the replicas of a key
+ * 				They are those of its partition, as placed by the partitioner chosen with PARTITIONER
  */
 vector<Node> MP2Node::findNodes(string key) {
-	size_t pos = hashFunction(key);
-	vector<Node> addr_vec;
-	if (ring.size() >= 3) {
-		// if pos <= min || pos > max, the leader is the min
-		if (pos <= ring.at(0).getHashCode() || pos > ring.at(ring.size()-1).getHashCode()) {
-			addr_vec.emplace_back(ring.at(0));
-			addr_vec.emplace_back(ring.at(1));
-			addr_vec.emplace_back(ring.at(2));
-		}
-		else {
-			// go through the ring until pos <= node
-			for (int i=1; i<ring.size(); i++){
-				Node addr = ring.at(i);
-				if (pos <= addr.getHashCode()) {
-					addr_vec.emplace_back(addr);
-					addr_vec.emplace_back(ring.at((i+1)%ring.size()));
-					addr_vec.emplace_back(ring.at((i+2)%ring.size()));
-					break;
-				}
-			}
+	return partitionMap.replicasOf(HashTable::partitionOf(key));
+}
+
+/**
+ * FUNCTION NAME: contactedReplicas
+ *
+ * DESCRIPTION: Replicas of the key the coordinator sends a request to: the ones whose
+ * 				suspicion level in the membership list of MP1Node is below PHI_SUSPECT.
+ * 				The suspected ones are only contacted when skipping them would leave less
+ * 				than a quorum, the placement of the key stays the one of findNodes.
+ */
+vector<Node> MP2Node::contactedReplicas(string key) {
+	vector<Node> replicas = findNodes(key);
+	vector<Node> trusted;
+	for ( size_t i = 0; i < replicas.size(); i++ ) {
+		Address *address = replicas[i].getAddress();
+		int index = memberNode->indexOfMember(*(int *)(&address->addr[0]), *(short *)(&address->addr[4]));
+		if ( index < 0 || memberNode->memberList[index].suspicion < PHI_SUSPECT ) {
+			trusted.push_back(replicas[i]);
 		}
 	}
-	return addr_vec;
+	return trusted.size() >= 2 ? trusted : replicas;
 }
 
 /**
  * FUNCTION NAME: recvLoop
  *
- * DESCRIPTION: Receive messages from EmulNet and push into the queue (mp2q)
+ * DESCRIPTION: Send the pending batches, then receive messages from EmulNet and push
+ * 				into the queue (mp2q)
  */
 bool MP2Node::recvLoop() {
     if ( memberNode->bFailed ) {
     	return false;
     }
     else {
+    	TraceSpan span("MP2Node::recvLoop", &memberNode->addr);
+    	// Messages of the stabilization protocol and of the last client calls
+    	this->flushMessages();
     	return emulNet->ENrecv(&(memberNode->addr), this->enqueueWrapper, NULL, 1, &(memberNode->mp2q));
     }
 }
@@ -472,21 +688,410 @@ int MP2Node::enqueueWrapper(void *env, char *buff, int size) {
  * 				The function does the following:
  *				1) Ensures that there are three "CORRECT" replicas of all the keys in spite of failures and joins
  *				Note:- "CORRECT" replicas implies that every key is replicated in its two neighboring nodes in the ring
+ *				Only the partitions whose replica set changed are moved, whole, to their new
+ *				replicas, and by a single one of the nodes holding them (see isSender).
+ *				The partitions still in flight to a peer that keeps them are sent again with
+ *				them, as one range stream per peer (see openStream) that replaces the streams
+ *				opened by the previous ring change.
  */
-void MP2Node::stabilizationProtocol() {
-	map<string, string>::iterator it;
-	for(it = this->ht->hashTable.begin(); it != this->ht->hashTable.end(); it++) {
-		string key = it->first;
-		string value = it->second;
-		Message stabilizationDeleteMsg = Message(-1, this->memberNode->addr, MessageType::DELETE, key);
-		for(int i=0;i<haveReplicasOf.size();i++) {
-			emulNet->ENsend(&memberNode->addr, haveReplicasOf[i].getAddress(), stabilizationDeleteMsg.toString());
+void MP2Node::stabilizationProtocol(const vector<int> &moved, PartitionMap &previous) {
+	TraceSpan span("MP2Node::stabilizationProtocol", &memberNode->addr);
+	map<string, vector<int> > sends;
+	map<string, Address> peers;
+	string self = memberNode->addr.getAddress();
+	set<string> members;
+	for ( size_t i = 0; i < ring.size(); i++ ) {
+		members.insert(ring[i].nodeAddress.getAddress());
+	}
+
+	map<string, OutStream>::iterator stream;
+	for ( stream = outStreams.begin(); stream != outStreams.end(); stream++ ) {
+		OutStream &s = stream->second;
+		for ( size_t i = 0; i < s.partitions.size(); i++ ) {
+			if ( partitionMap.isReplica(s.partitions[i], s.to) ) {
+				sends[stream->first].push_back(s.partitions[i]);
+				peers[stream->first] = s.to;
+			}
 		}
+	}
+	for ( size_t i = 0; i < moved.size(); i++ ) {
+		if ( this->ht->partition(moved[i]).empty() ) {
+			continue;
+		}
+		if ( !partitionMap.isReplica(moved[i], memberNode->addr) ) {
+			handedOver.insert(make_pair(moved[i], par->getcurrtime()));
+		}
+		if ( !isSender(moved[i], previous.replicasOf(moved[i]), members) ) {
+			continue;
+		}
+		const vector<Node> &replicas = partitionMap.replicasOf(moved[i]);
+		for ( size_t j = 0; j < replicas.size(); j++ ) {
+			Address address = replicas[j].nodeAddress;
+			string peer = address.getAddress();
+			if ( peer == self || previous.isReplica(moved[i], address) ) {
+				continue;
+			}
+			sends[peer].push_back(moved[i]);
+			peers[peer] = address;
+		}
+	}
 
-		vector<Node> replicas = findNodes(key);
-		Message stabilizationCreateMsg = Message(-1, this->memberNode->addr, MessageType::CREATE, key, value);
-		for (int i = 0; i < replicas.size(); i++) {
-			emulNet->ENsend(&memberNode->addr, replicas[i].getAddress(), stabilizationCreateMsg.toString());
+	outStreams.clear();
+	map<string, vector<int> >::iterator send;
+	for ( send = sends.begin(); send != sends.end(); send++ ) {
+		vector<int> &partitions = send->second;
+		sort(partitions.begin(), partitions.end());
+		partitions.erase(unique(partitions.begin(), partitions.end()), partitions.end());
+		this->openStream(send->first, peers[send->first], partitions);
+	}
+}
+
+/**
+ * FUNCTION NAME: isSender
+ *
+ * DESCRIPTION: Whether this node streams a moved partition to its new replicas. Of its
+ * 				previous replicas still in the ring, the first one that stopped replicating
+ * 				it sends it, so that it can delete it once acknowledged, or else the first
+ * 				one. When none of them is left, every node holding it sends it.
+ */
+bool MP2Node::isSender(int partition, const vector<Node> &previous, const set<string> &members) {
+	int first = -1;
+	for ( size_t i = 0; i < previous.size(); i++ ) {
+		Address address = previous[i].nodeAddress;
+		if ( !members.count(address.getAddress()) ) {
+			continue;
+		}
+		if ( !partitionMap.isReplica(partition, address) ) {
+			return address == memberNode->addr;
 		}
+		if ( first < 0 ) {
+			first = i;
+		}
+	}
+	if ( first < 0 ) {
+		return true;
+	}
+	Address address = previous[first].nodeAddress;
+	return address == memberNode->addr;
+}
+
+/**
+ * FUNCTION NAME: openStream
+ *
+ * DESCRIPTION: Read the keys of the given sorted partitions and open a range stream of
+ * 				them to peer, in place of its current one
+ */
+void MP2Node::openStream(const string &peer, Address to, const vector<int> &partitions) {
+	// every partition is sorted, so the run is sorted within each partition
+	vector<pair<string, string> > run;
+	for ( size_t i = 0; i < partitions.size(); i++ ) {
+		map<string, string> &keys = this->ht->partition(partitions[i]);
+		run.insert(run.end(), keys.begin(), keys.end());
+	}
+	if ( run.empty() ) {
+		outStreams.erase(peer);
+		return;
+	}
+	int maxChunkSize = par->MAX_MSG_SIZE - BATCH_HEADROOM - STREAM_HEADROOM;
+	OutStream s(nextStreamID++, to, RangeStream::encode(run, maxChunkSize), par->getcurrtime());
+	s.partitions = partitions;
+	outStreams[peer] = s;
+	stabilizationKeys->add(run.size());
+}
+
+/**
+ * FUNCTION NAME: sendChunk
+ */
+void MP2Node::sendChunk(OutStream &s, int chunk) {
+	bool last = (chunk == (int)s.chunks.size() - 1);
+	Message data = Message(s.id, memberNode->addr, MessageType::STREAMDATA, chunk, last, s.chunks[chunk]);
+	data.snapshot = s.snapshot;
+	sendMessage(&s.to, data.toString());
+	stabilizationBytes->add(s.chunks[chunk].size());
+}
+
+/**
+ * FUNCTION NAME: sendStreams
+ *
+ * DESCRIPTION: Send the chunks of every open stream that fit in its window.
+ * 				When a stream made no progress for STREAM_TIMEOUT ticks, the chunks in
+ * 				flight that were not received are sent again; after STREAM_RETRIES such
+ * 				timeouts the peer is assumed gone and the stream is dropped. A stream
+ * 				whose snapshot is older than STREAM_MAX_AGE is read again.
+ */
+void MP2Node::sendStreams() {
+	int now = par->getcurrtime();
+	map<string, OutStream>::iterator it = outStreams.begin();
+	while ( it != outStreams.end() ) {
+		OutStream &s = it->second;
+		if ( now - s.snapshot > STREAM_MAX_AGE ) {
+			string peer = it->first;
+			Address to = s.to;
+			vector<int> partitions = s.partitions;
+			outStreams.erase(it++);
+			// sent from the next tick on
+			this->openStream(peer, to, partitions);
+			continue;
+		}
+		if ( s.next > s.acked && now - s.lastProgress > STREAM_TIMEOUT ) {
+			if ( ++s.timeouts > STREAM_RETRIES ) {
+				outStreams.erase(it++);
+				continue;
+			}
+			for ( int chunk = s.acked; chunk < s.next; chunk++ ) {
+				if ( !s.received[chunk] ) {
+					sendChunk(s, chunk);
+				}
+			}
+			s.lastProgress = now;
+		}
+		while ( s.next < (int)s.chunks.size() && s.next < s.acked + STREAM_WINDOW ) {
+			sendChunk(s, s.next++);
+		}
+		it++;
+	}
+}
+
+/**
+ * FUNCTION NAME: handleStreamData
+ *
+ * DESCRIPTION: Apply a chunk of the stream of the sender not applied yet, in any order, and
+ * 				acknowledge the chunks received: all of them up to the first one missing,
+ * 				and a mask of the ones past it. The keys a client wrote since the snapshot
+ * 				of the stream are left alone, and chunks older than STREAM_MAX_AGE, whose
+ * 				writes may be forgotten, are refused. A newer stream of the same sender
+ * 				replaces the old one; chunks of older streams are dropped.
+ */
+void MP2Node::handleStreamData(Message msg) {
+	if ( rejoinRounds > 0 ) {
+		rejoinHeard.insert(msg.fromAddr.getAddress());
+	}
+	InStream &s = inStreams[msg.fromAddr.getAddress()];
+	if ( msg.transID < s.id || par->getcurrtime() - msg.snapshot > STREAM_MAX_AGE ) {
+		return;
+	}
+	if ( msg.transID > s.id ) {
+		s.id = msg.transID;
+		s.next = 0;
+		s.ahead.clear();
+	}
+	if ( msg.offset >= s.next && s.ahead.count(msg.offset) == 0 ) {
+		vector<pair<string, string> > records;
+		if ( !RangeStream::decode(msg.value, records) ) {
+			return;
+		}
+		size_t kept = 0;
+		for ( size_t i = 0; i < records.size(); i++ ) {
+			if ( ht->changedAt(records[i].first) < msg.snapshot ) {
+				records[kept++].swap(records[i]);
+			}
+		}
+		records.resize(kept);
+		TraceSpan span("store.stream", &memberNode->addr);
+		ht->createBatch(records);
+		s.ahead.insert(msg.offset);
+		while ( s.ahead.count(s.next) ) {
+			s.ahead.erase(s.next++);
+		}
+	}
+	unsigned int received = 0;
+	set<int>::iterator it;
+	for ( it = s.ahead.begin(); it != s.ahead.end() && *it - s.next - 1 < 32; it++ ) {
+		received |= 1u << (*it - s.next - 1);
+	}
+	Message ack = Message(s.id, memberNode->addr, MessageType::STREAMACK, s.next, false, "");
+	ack.received = received;
+	sendMessage(&msg.fromAddr, ack.toString());
+}
+
+/**
+ * FUNCTION NAME: handleStreamAck
+ *
+ * DESCRIPTION: Slide the window of the stream to the acknowledged chunk, note the chunks
+ * 				received past it and close the stream once every chunk is acknowledged
+ */
+void MP2Node::handleStreamAck(Message msg) {
+	map<string, OutStream>::iterator search = outStreams.find(msg.fromAddr.getAddress());
+	if ( search == outStreams.end() || search->second.id != msg.transID ) {
+		return;
+	}
+	OutStream &s = search->second;
+	if ( msg.offset > s.acked ) {
+		s.acked = msg.offset;
+		s.lastProgress = par->getcurrtime();
+		s.timeouts = 0;
+		if ( s.next < s.acked ) {
+			s.next = s.acked;
+		}
+	}
+	for ( int bit = 0; bit < 32; bit++ ) {
+		int chunk = msg.offset + 1 + bit;
+		if ( (msg.received & (1u << bit)) && chunk < (int)s.chunks.size() ) {
+			s.received[chunk] = true;
+		}
+	}
+	if ( s.acked >= (int)s.chunks.size() ) {
+		vector<int> partitions = s.partitions;
+		outStreams.erase(search);
+		// Partitions handed over for good are not kept around
+		for ( size_t i = 0; i < partitions.size(); i++ ) {
+			if ( !partitionMap.isReplica(partitions[i], memberNode->addr) && !inFlight(partitions[i]) ) {
+				ht->dropPartition(partitions[i]);
+				handedOver.erase(partitions[i]);
+			}
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: inFlight
+ *
+ * DESCRIPTION: Whether an open stream carries the partition
+ */
+bool MP2Node::inFlight(int partition) {
+	map<string, OutStream>::iterator it;
+	for ( it = outStreams.begin(); it != outStreams.end(); it++ ) {
+		if ( find(it->second.partitions.begin(), it->second.partitions.end(), partition) != it->second.partitions.end() ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * FUNCTION NAME: dropHandedOver
+ *
+ * DESCRIPTION: Delete the partitions this node stopped replicating STREAM_MAX_AGE ticks ago
+ * 				and does not stream anymore. By then their sender handed them over or gave up.
+ * 				The ones this node streams are deleted once acknowledged, see handleStreamAck.
+ * 				Every STREAM_MAX_AGE ticks, the keys written here since by coordinators or
+ * 				streams that placed them on an older ring are found the same way.
+ */
+void MP2Node::dropHandedOver() {
+	int now = par->getcurrtime();
+	if ( !ring.empty() && now % STREAM_MAX_AGE == 0 ) {
+		for ( int partition = 0; partition < PARTITIONS; partition++ ) {
+			if ( !this->ht->partition(partition).empty() && !partitionMap.isReplica(partition, memberNode->addr) ) {
+				handedOver.insert(make_pair(partition, now));
+			}
+		}
+	}
+	map<int, int>::iterator it = handedOver.begin();
+	while ( it != handedOver.end() ) {
+		if ( partitionMap.isReplica(it->first, memberNode->addr) ) {
+			handedOver.erase(it++);
+			continue;
+		}
+		if ( now - it->second < STREAM_MAX_AGE || inFlight(it->first) ) {
+			it++;
+			continue;
+		}
+		ht->dropPartition(it->first);
+		handedOver.erase(it++);
+	}
+}
+
+/**
+ * FUNCTION NAME: rejoinLoop
+ *
+ * DESCRIPTION: A node back from a crash is empty, but if the ring kept it, the replica sets
+ * 				did not change and nothing moves to it. Once its ring is built again, it asks
+ * 				the other nodes for its partitions, and asks again every STREAM_TIMEOUT ticks
+ * 				the ones that did not start streaming, STREAM_RETRIES times at most.
+ */
+void MP2Node::rejoinLoop() {
+	int now = par->getcurrtime();
+	if ( rejoinRounds == 0 || ring.size() < 2 || now - rejoinSentAt < STREAM_TIMEOUT ) {
+		return;
+	}
+	rejoinRounds--;
+	rejoinSentAt = now;
+	Message msg = Message(0, memberNode->addr, MessageType::REJOIN, "", "");
+	for ( size_t i = 0; i < ring.size(); i++ ) {
+		Address address = ring[i].nodeAddress;
+		if ( address == memberNode->addr || rejoinHeard.count(address.getAddress()) ) {
+			continue;
+		}
+		sendMessage(&address, msg.toString());
+	}
+}
+
+/**
+ * FUNCTION NAME: handleRejoin
+ *
+ * DESCRIPTION: Treat a node back from a crash as a placement change: stream it the
+ * 				partitions it replicates along with this node, adding them to the stream
+ * 				already open to it, if any
+ */
+void MP2Node::handleRejoin(Address from) {
+	string peer = from.getAddress();
+	vector<int> partitions;
+	map<string, OutStream>::iterator search = outStreams.find(peer);
+	if ( search != outStreams.end() ) {
+		partitions = search->second.partitions;
+	}
+	size_t inFlight = partitions.size();
+	for ( int partition = 0; partition < PARTITIONS; partition++ ) {
+		if ( !partitionMap.isReplica(partition, from) || !partitionMap.isReplica(partition, memberNode->addr) ) {
+			continue;
+		}
+		if ( this->ht->partition(partition).empty() || binary_search(partitions.begin(), partitions.begin() + inFlight, partition) ) {
+			continue;
+		}
+		partitions.push_back(partition);
+	}
+	if ( partitions.size() == inFlight ) {
+		return;
+	}
+	sort(partitions.begin(), partitions.end());
+	this->openStream(peer, from, partitions);
+}
+
+/**
+ * FUNCTION NAME: applyPlacement
+ *
+ * DESCRIPTION: Place the partitions on the current ring with the moves of the rebalancer
+ * 				and move the ones whose replica set changed
+ */
+void MP2Node::applyPlacement() {
+	PartitionMap previous = partitionMap;
+	this->stabilizationProtocol(partitionMap.update(partitioner, ring, rebalancer.moves), previous);
+}
+
+/**
+ * FUNCTION NAME: rebalanceLoop
+ *
+ * DESCRIPTION: Every REBALANCE ticks, report the load of this node to the leader (the first
+ * 				node of the ring). The leader plans a rebalancing round from the reports of
+ * 				the previous period and sends the current moves to every node, whether or
+ * 				not they changed.
+ */
+void MP2Node::rebalanceLoop() {
+	int now = par->getcurrtime();
+	if ( !rebalancePeriod || ring.empty() || now % rebalancePeriod != 0 ) {
+		return;
+	}
+	Address *leader = ring[0].getAddress();
+	string report = rebalancer.report(ht);
+	if ( !(*leader == memberNode->addr) ) {
+		Message msg = Message(0, memberNode->addr, MessageType::LOADREPORT, "", report);
+		sendMessage(leader, msg.toString());
+		return;
+	}
+	rebalancer.receiveReport(memberNode->addr.getAddress(), report, now);
+	bool changed = rebalancer.plan(partitionMap, ring, now, rebalancePeriod);
+	if ( changed ) {
+		rebalancer.version = now;
+	}
+	if ( rebalancer.version < 0 ) {
+		return;
+	}
+	// Resent every period, so nodes that lost it or joined since still converge
+	Message msg = Message(rebalancer.version, memberNode->addr, MessageType::REBALANCE, "", rebalancer.encodeMoves());
+	for ( size_t i = 1; i < ring.size(); i++ ) {
+		sendMessage(ring[i].getAddress(), msg.toString());
+	}
+	if ( changed ) {
+		this->applyPlacement();
 	}
 }
@@ -11,13 +11,22 @@
  * Header files
  */
 #include "stdincludes.h"
-#include "EmulNet.h"
+#include "Transport.h"
 #include "Node.h"
 #include "HashTable.h"
 #include "Log.h"
 #include "Params.h"
 #include "Message.h"
+#include "MessageBatch.h"
+#include "RangeStream.h"
 #include "Queue.h"
+#include "Partitioner.h"
+#include "Rebalancer.h"
+#include "FailureDetector.h"
+#include "Stats.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "ClientTrace.h"
 
 struct Transaction {
 	int id;
@@ -26,9 +35,13 @@ struct Transaction {
 	string value;
 	bool isFinished;
 	int created_at;
+	// monotonic time of the dispatch in nanoseconds, for the latency statistics
+	unsigned long started_at;
+	// replicas the request was sent to, the transaction is over once they all replied
+	int replicas;
 	int allReply;
 	int successReply;
-	Transaction(int _id, MessageType _type, string _key, string _value, int _created_at): id(_id), type(_type), key(_key), value(_value), created_at(_created_at), isFinished(false) {}
+	Transaction(int _id, MessageType _type, string _key, string _value, int _created_at, int _replicas): id(_id), type(_type), key(_key), value(_value), isFinished(false), created_at(_created_at), started_at(Stats::now()), replicas(_replicas), allReply(0), successReply(0) {}
 };
 
 /**
@@ -49,21 +62,69 @@ private:
 	vector<Node> haveReplicasOf;
 	// Ring
 	vector<Node> ring;
+	// Membership epoch the ring was built from
+	long ringEpoch;
+	// Maps partitions to their replicas among the nodes of the ring
+	Partitioner *partitioner;
+	PartitionMap partitionMap;
+	Rebalancer rebalancer;
+	// Latencies and throughput of the CRUD operations, reported every STATS_PERIOD ticks
+	Stats stats;
+	// STATS_PERIOD and REBALANCE, 0 when they are disabled
+	int statsPeriod;
+	int rebalancePeriod;
+	// Metrics of this node in the registry
+	Gauge *storeKeys;
+	Gauge *storeBytes;
+	Gauge *openTransactions;
+	Counter *stabilizationKeys;
+	Counter *stabilizationBytes;
 	// Hash Table
 	HashTable * ht;
 	// Member representing this member
 	Member *memberNode;
 	// Params object
 	Params *par;
-	// Object of EmulNet
-	EmulNet * emulNet;
+	// Object of the Transport (EmulNet or a real network backend)
+	Transport * emulNet;
 	// Object of Log
 	Log * log;
 
 	vector<Transaction*> transactions;
+	// Transactions before this one are finished and freed
+	size_t oldestOpen;
+	// Outbound messages of this tick, one batch per destination address
+	map<string, MessageBatch> outbox;
+
+	// Range transfers of the stabilization protocol, by peer address
+	map<string, OutStream> outStreams;
+	map<string, InStream> inStreams;
+	int nextStreamID;
+	// After a restart, requests left to ask the ring for the partitions of this node,
+	// when the last one was sent and the peers that started streaming them back
+	int rejoinRounds;
+	int rejoinSentAt;
+	set<string> rejoinHeard;
+	// Partitions held here that this node no longer replicates, by the tick they moved away
+	map<int, int> handedOver;
+
+	void sendMessage(Address *toAddr, string message);
+	void handleMessage(Message msg);
+	void handleStreamData(Message msg);
+	void handleStreamAck(Message msg);
+	bool isSender(int partition, const vector<Node> &previous, const set<string> &members);
+	void openStream(const string &peer, Address to, const vector<int> &partitions);
+	bool inFlight(int partition);
+	void dropHandedOver();
+	void sendChunk(OutStream &s, int chunk);
+	void sendStreams();
+	void rejoinLoop();
+	void handleRejoin(Address from);
+	void rebalanceLoop();
+	void applyPlacement();
 
 public:
-	MP2Node(Member *memberNode, Params *par, EmulNet *emulNet, Log *log, Address *addressOfMember);
+	MP2Node(Member *memberNode, Params *par, Transport *emulNet, Log *log, Address *addressOfMember);
 	Member * getMemberNode() {
 		return this->memberNode;
 	}
@@ -86,15 +147,19 @@ public:
 
 	// handle messages from receiving queue
 	void checkMessages();
+	// send the batched outbound messages
+	void flushMessages();
 
 	// coordinator dispatches messages to corresponding nodes
-	Message dispatchMessage(MessageType msgType, string key, string value="");
+	Message dispatchMessage(MessageType msgType, int replicas, string key, string value="");
 	void createTransaction(Message msg);
 	void updateTransaction(Message msg);
 	void logTransaction(Transaction* t, bool success);
 
 	// find the addresses of nodes that are responsible for a key
 	vector<Node> findNodes(string key);
+	// the ones of them the coordinator sends a request to
+	vector<Node> contactedReplicas(string key);
 
 	// server
 	bool createKeyValue(string key, string value, ReplicaType replica, int transID, MessageType msgType);
@@ -103,7 +168,10 @@ public:
 	bool deletekey(string key, int transID);
 
 	// stabilization protocol - handle multiple failures
-	void stabilizationProtocol();
+	void stabilizationProtocol(const vector<int> &moved, PartitionMap &previous);
+
+	// come back from a crash
+	void restart();
 
 	~MP2Node();
 };
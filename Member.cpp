@@ -38,12 +38,12 @@ bool Address::operator ==(const Address& anotherAddress) {
 /**
  * Constructor
  */
-MemberListEntry::MemberListEntry(int id, short port, long heartbeat, long timestamp): id(id), port(port), heartbeat(heartbeat), timestamp(timestamp) {}
+MemberListEntry::MemberListEntry(int id, short port, long heartbeat, long timestamp): id(id), port(port), heartbeat(heartbeat), timestamp(timestamp), version(0), incarnation(0), state(MEMBER_ALIVE), suspicion(0) {}
 
 /**
  * Constuctor
  */
-MemberListEntry::MemberListEntry(int id, short port): id(id), port(port) {}
+MemberListEntry::MemberListEntry(int id, short port): id(id), port(port), version(0), incarnation(0), state(MEMBER_ALIVE), suspicion(0) {}
 
 /**
  * Copy constructor
@@ -53,6 +53,10 @@ MemberListEntry::MemberListEntry(const MemberListEntry &anotherMLE) {
 	this->id = anotherMLE.id;
 	this->port = anotherMLE.port;
 	this->timestamp = anotherMLE.timestamp;
+	this->version = anotherMLE.version;
+	this->incarnation = anotherMLE.incarnation;
+	this->state = anotherMLE.state;
+	this->suspicion = anotherMLE.suspicion;
 }
 
 /**
@@ -64,6 +68,10 @@ MemberListEntry& MemberListEntry::operator =(const MemberListEntry &anotherMLE)
 	swap(id, temp.id);
 	swap(port, temp.port);
 	swap(timestamp, temp.timestamp);
+	swap(version, temp.version);
+	swap(incarnation, temp.incarnation);
+	swap(state, temp.state);
+	swap(suspicion, temp.suspicion);
 	return *this;
 }
 
@@ -152,6 +160,8 @@ Member::Member(const Member &anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
+	this->memberIndex = anotherMember.memberIndex;
+	this->epoch = anotherMember.epoch;
 	this->myPos = anotherMember.myPos;
 	this->mp1q = anotherMember.mp1q;
 	this->mp2q = anotherMember.mp2q;
@@ -170,8 +180,72 @@ Member& Member::operator =(const Member& anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
+	this->memberIndex = anotherMember.memberIndex;
+	this->epoch = anotherMember.epoch;
 	this->myPos = anotherMember.myPos;
 	this->mp1q = anotherMember.mp1q;
 	this->mp2q = anotherMember.mp2q;
 	return *this;
 }
+
+/**
+ * FUNCTION NAME: memberKey
+ *
+ * DESCRIPTION: Key of a member in memberIndex
+ */
+long Member::memberKey(int id, short port) {
+	return ((long)id << 16) | (unsigned short)port;
+}
+
+/**
+ * FUNCTION NAME: indexOfMember
+ *
+ * RETURNS:
+ * position of the member in memberList, -1 if it is not there
+ */
+int Member::indexOfMember(int id, short port) {
+	unordered_map<long, int>::iterator search = memberIndex.find(memberKey(id, port));
+	if ( search == memberIndex.end() ) {
+		return -1;
+	}
+	return search->second;
+}
+
+/**
+ * FUNCTION NAME: addMember
+ *
+ * DESCRIPTION: Append an entry to memberList
+ */
+void Member::addMember(const MemberListEntry &entry) {
+	memberIndex[memberKey(entry.id, entry.port)] = memberList.size();
+	memberList.push_back(entry);
+	epoch++;
+}
+
+/**
+ * FUNCTION NAME: removeMember
+ *
+ * DESCRIPTION: Remove the entry at index from memberList by moving the last entry in its place
+ */
+void Member::removeMember(int index) {
+	memberIndex.erase(memberKey(memberList[index].id, memberList[index].port));
+	if ( index != (int)memberList.size() - 1 ) {
+		memberList[index] = memberList.back();
+		memberIndex[memberKey(memberList[index].id, memberList[index].port)] = index;
+	}
+	memberList.pop_back();
+	epoch++;
+}
+
+/**
+ * FUNCTION NAME: reindexMembers
+ *
+ * DESCRIPTION: Rebuild memberIndex after memberList was replaced
+ */
+void Member::reindexMembers() {
+	memberIndex.clear();
+	for ( unsigned int i = 0; i < memberList.size(); i++ ) {
+		memberIndex[memberKey(memberList[i].id, memberList[i].port)] = i;
+	}
+	epoch++;
+}
@@ -8,6 +8,7 @@
 #define MEMBER_H_
 
 #include "stdincludes.h"
+#include <unordered_map>
 
 /**
  * CLASS NAME: q_elt
@@ -54,6 +55,9 @@ public:
 	}
 };
 
+// states of a member in the SWIM membership protocol, dead members leave the list
+enum memberSTATE { MEMBER_ALIVE, MEMBER_SUSPECT, MEMBER_DEAD };
+
 /**
  * CLASS NAME: MemberListEntry
  *
@@ -65,9 +69,16 @@ public:
 	short port;
 	long heartbeat;
 	long timestamp;
+	// local version of the last change of this entry, see MP1Node::touch
+	long version;
+	// SWIM incarnation number and state of the member
+	int incarnation;
+	int state;
+	// suspicion level computed by MP1Node, see FailureDetector
+	double suspicion;
 	MemberListEntry(int id, short port, long heartbeat, long timestamp);
 	MemberListEntry(int id, short port);
-	MemberListEntry(): id(0), port(0), heartbeat(0), timestamp(0) {}
+	MemberListEntry(): id(0), port(0), heartbeat(0), timestamp(0), version(0), incarnation(0), state(MEMBER_ALIVE), suspicion(0) {}
 	MemberListEntry(const MemberListEntry &anotherMLE);
 	MemberListEntry& operator =(const MemberListEntry &anotherMLE);
 	int getid();
@@ -106,6 +117,10 @@ public:
 	int timeOutCounter;
 	// Membership table
 	vector<MemberListEntry> memberList;
+	// Position of every member in memberList, keyed by memberKey
+	unordered_map<long, int> memberIndex;
+	// Membership epoch, incremented whenever the members usable by the KV store change
+	long epoch;
 	// My position in the membership table
 	vector<MemberListEntry>::iterator myPos;
 	// Queue for failure detection messages
@@ -115,11 +130,17 @@ public:
 	/**
 	 * Constructor
 	 */
-	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0) {}
+	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0), epoch(0) {}
 	// copy constructor
 	Member(const Member &anotherMember);
 	// Assignment operator overloading
 	Member& operator =(const Member &anotherMember);
+	// memberList operations keeping memberIndex up to date
+	static long memberKey(int id, short port);
+	int indexOfMember(int id, short port);
+	void addMember(const MemberListEntry &entry);
+	void removeMember(int index);
+	void reindexMembers();
 	virtual ~Member() {}
 };
 
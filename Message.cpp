@@ -14,18 +14,26 @@
 // transID::fromAddr::DELETE::key
 // transID::fromAddr::REPLY::sucess
 // transID::fromAddr::READREPLY::value
+// streamID::fromAddr::STREAMDATA::offset::last::snapshot::payload
+// streamID::fromAddr::STREAMACK::offset::received
+// 0::fromAddr::LOADREPORT::payload
+// version::fromAddr::REBALANCE::payload
+// 0::fromAddr::REJOIN::
 Message::Message(string message){
 	this->delimiter = "::";
 	vector<string> tuple;
+	vector<size_t> starts;
 	size_t pos = message.find(delimiter);
 	size_t start = 0;
 	while (pos != string::npos) {
 		string field = message.substr(start, pos-start);
 		tuple.push_back(field);
+		starts.push_back(start);
 		start = pos + 2;
 		pos = message.find(delimiter, start);
 	}
 	tuple.push_back(message.substr(start));
+	starts.push_back(start);
 
 	transID = stoi(tuple.at(0));
 	Address addr(tuple.at(1));
@@ -52,6 +60,23 @@ Message::Message(string message){
 		case READREPLY:
 			value = tuple.at(3);
 			break;
+		case STREAMDATA:
+			offset = stoi(tuple.at(3));
+			last = (tuple.at(4) == "1");
+			snapshot = stoi(tuple.at(5));
+			// the payload is binary and may hold the delimiter
+			value = message.substr(starts.at(6));
+			break;
+		case STREAMACK:
+			offset = stoi(tuple.at(3));
+			received = stoul(tuple.at(4));
+			break;
+		case LOADREPORT:
+		case REBALANCE:
+			value = message.substr(starts.at(3));
+			break;
+		case REJOIN:
+			break;
 	}
 }
 
@@ -81,6 +106,10 @@ Message::Message(const Message& anotherMessage) {
 	this->transID = anotherMessage.transID;
 	this->type = anotherMessage.type;
 	this->value = anotherMessage.value;
+	this->offset = anotherMessage.offset;
+	this->last = anotherMessage.last;
+	this->snapshot = anotherMessage.snapshot;
+	this->received = anotherMessage.received;
 }
 
 /**
@@ -131,6 +160,22 @@ Message::Message(int _transID, Address _fromAddr, string _value){
 	value = _value;
 }
 
+/**
+ * Constructor
+ */
+// construct stream data or stream ack message
+Message::Message(int _transID, Address _fromAddr, MessageType _type, int _offset, bool _last, string _payload){
+	this->delimiter = "::";
+	transID = _transID;
+	fromAddr = _fromAddr;
+	type = _type;
+	offset = _offset;
+	last = _last;
+	value = _payload;
+	snapshot = 0;
+	received = 0;
+}
+
 /**
  * FUNCTION NAME: toString
  *
@@ -156,6 +201,18 @@ string Message::toString(){
 		case READREPLY:
 			message += value;
 			break;
+		case STREAMDATA:
+			message += to_string(offset) + delimiter + (last ? "1" : "0") + delimiter + to_string(snapshot) + delimiter + value;
+			break;
+		case STREAMACK:
+			message += to_string(offset) + delimiter + to_string(received);
+			break;
+		case LOADREPORT:
+		case REBALANCE:
+			message += value;
+			break;
+		case REJOIN:
+			break;
 	}
 	return message;
 }
@@ -172,5 +229,9 @@ Message& Message::operator =(const Message& anotherMessage) {
 	this->transID = anotherMessage.transID;
 	this->type = anotherMessage.type;
 	this->value = anotherMessage.value;
+	this->offset = anotherMessage.offset;
+	this->last = anotherMessage.last;
+	this->snapshot = anotherMessage.snapshot;
+	this->received = anotherMessage.received;
 	return *this;
 }
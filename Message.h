@@ -24,6 +24,10 @@ public:
 	Address fromAddr;
 	int transID;
 	bool success; // success or not
+	int offset; // chunk of a stream
+	bool last; // last chunk of a stream
+	int snapshot; // tick the chunks of a stream were read at
+	unsigned int received; // chunks received past offset, one bit each
 	// delimiter
 	string delimiter;
 	// construct a message from a string
@@ -38,6 +42,8 @@ public:
 	Message(int _transID, Address _fromAddr, MessageType _type, bool _success);
 	// construct read reply message
 	Message(int _transID, Address _fromAddr, string _value);
+	// construct stream data or stream ack message, transID being the stream id
+	Message(int _transID, Address _fromAddr, MessageType _type, int _offset, bool _last, string _payload);
 	Message& operator = (const Message& anotherMessage);
 	// serialize to a string
 	string toString();
@@ -0,0 +1,81 @@
+/**********************************
+ * FILE NAME: MessageBatch.cpp
+ *
+ * DESCRIPTION: MessageBatch class definition
+ **********************************/
+#include "MessageBatch.h"
+
+/**
+ * Constructor
+ */
+MessageBatch::MessageBatch(Address to, int maxFrameSize): maxFrameSize(maxFrameSize), to(to) {}
+
+/**
+ * FUNCTION NAME: append
+ *
+ * DESCRIPTION: Add a message to the last frame, opening a new frame when it does not fit
+ */
+void MessageBatch::append(string message) {
+	int record = sizeof(int) + message.size();
+	if ( frames.empty() || (int)frames.back().size() + record > maxFrameSize ) {
+		frames.push_back(string(1, BATCH_MAGIC));
+		counts.push_back(0);
+	}
+	int len = message.size();
+	frames.back().append((char *)&len, sizeof(int));
+	frames.back().append(message);
+	counts.back()++;
+}
+
+/**
+ * FUNCTION NAME: empty
+ */
+bool MessageBatch::empty() {
+	return frames.empty();
+}
+
+/**
+ * FUNCTION NAME: takeFrames
+ *
+ * DESCRIPTION: Hand out the frames to send and empty the batch
+ */
+vector<string> MessageBatch::takeFrames() {
+	vector<string> out;
+	out.swap(frames);
+	for ( size_t i = 0; i < out.size(); i++ ) {
+		if ( counts[i] == 1 ) {
+			out[i] = out[i].substr(1 + sizeof(int));
+		}
+	}
+	counts.clear();
+	return out;
+}
+
+/**
+ * FUNCTION NAME: isBatch
+ */
+bool MessageBatch::isBatch(char *data, int size) {
+	return size > 0 && data[0] == BATCH_MAGIC;
+}
+
+/**
+ * FUNCTION NAME: unpack
+ *
+ * DESCRIPTION: Split a batch frame back into the serialized messages.
+ * 				A truncated trailing record is dropped.
+ */
+vector<string> MessageBatch::unpack(char *data, int size) {
+	vector<string> messages;
+	int pos = 1;
+	while ( pos + (int)sizeof(int) <= size ) {
+		int len;
+		memcpy(&len, data + pos, sizeof(int));
+		pos += sizeof(int);
+		if ( len < 0 || pos + len > size ) {
+			break;
+		}
+		messages.push_back(string(data + pos, data + pos + len));
+		pos += len;
+	}
+	return messages;
+}
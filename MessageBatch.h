@@ -0,0 +1,44 @@
+/**********************************
+ * FILE NAME: MessageBatch.h
+ *
+ * DESCRIPTION: MessageBatch class header file
+ **********************************/
+#ifndef MESSAGEBATCH_H_
+#define MESSAGEBATCH_H_
+
+/*
+ * Macros
+ */
+// First byte of a batch frame, never the first byte of a text Message
+#define BATCH_MAGIC '\x1e'
+// Room left in every frame for the header of the transport
+#define BATCH_HEADROOM 64
+
+#include "stdincludes.h"
+#include "Member.h"
+
+/**
+ * CLASS NAME: MessageBatch
+ *
+ * DESCRIPTION: Outbound messages of one node to one destination, packed into frames.
+ * 				A frame is BATCH_MAGIC followed by records made of an int length and
+ * 				the serialized Message. A frame holding a single message is sent as the
+ * 				plain message, so the receiver only unpacks frames starting with BATCH_MAGIC.
+ */
+class MessageBatch {
+private:
+	int maxFrameSize;
+	vector<string> frames;
+	vector<int> counts;
+public:
+	Address to;
+	MessageBatch(): maxFrameSize(0) {}
+	MessageBatch(Address to, int maxFrameSize);
+	void append(string message);
+	bool empty();
+	vector<string> takeFrames();
+	static bool isBatch(char *data, int size);
+	static vector<string> unpack(char *data, int size);
+};
+
+#endif /* MESSAGEBATCH_H_ */
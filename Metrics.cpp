@@ -0,0 +1,299 @@
+/**********************************
+ * FILE NAME: Metrics.cpp
+ *
+ * DESCRIPTION: Definition of the metrics registry and its Prometheus text exposition
+ **********************************/
+
+#include "Metrics.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+
+/**
+ * FUNCTION NAME: metrics
+ */
+MetricsRegistry &metrics() {
+	static MetricsRegistry registry;
+	return registry;
+}
+
+/**
+ * FUNCTION NAME: seriesName
+ *
+ * DESCRIPTION: name{labels}, or name alone without labels
+ */
+static string seriesName(const string &name, const string &labels) {
+	return labels.empty() ? name : name + "{" + labels + "}";
+}
+
+/**
+ * constructor
+ */
+Counter::Counter() {
+	for ( int i = 0; i < METRICS_SHARDS; i++ ) {
+		shards[i].value.store(0, memory_order_relaxed);
+	}
+}
+
+/**
+ * FUNCTION NAME: value
+ */
+unsigned long Counter::value() {
+	unsigned long sum = 0;
+	for ( int i = 0; i < METRICS_SHARDS; i++ ) {
+		sum += shards[i].value.load(memory_order_relaxed);
+	}
+	return sum;
+}
+
+/**
+ * FUNCTION NAME: expose
+ */
+void Counter::expose(string &out, const string &name, const string &labels) {
+	out += seriesName(name, labels) + " " + to_string(value()) + "\n";
+}
+
+/**
+ * FUNCTION NAME: expose
+ */
+void Gauge::expose(string &out, const string &name, const string &labels) {
+	out += seriesName(name, labels) + " " + to_string(value()) + "\n";
+}
+
+/**
+ * constructor
+ */
+HistogramMetric::HistogramMetric() {
+	for ( int i = 0; i < METRICS_SHARDS; i++ ) {
+		shards[i].histogram = NULL;
+	}
+}
+
+/**
+ * Destructor
+ */
+HistogramMetric::~HistogramMetric() {
+	for ( int i = 0; i < METRICS_SHARDS; i++ ) {
+		delete shards[i].histogram;
+	}
+}
+
+/**
+ * FUNCTION NAME: observe
+ *
+ * DESCRIPTION: Record a duration in the shard of the calling thread, allocated on first use
+ */
+void HistogramMetric::observe(unsigned long nanos) {
+	Shard &shard = shards[metricsShard()];
+	lock_guard<mutex> guard(shard.lock);
+	if ( shard.histogram == NULL ) {
+		shard.histogram = new Histogram();
+	}
+	shard.histogram->record(nanos);
+}
+
+/**
+ * FUNCTION NAME: snapshot
+ *
+ * DESCRIPTION: The shards merged
+ */
+Histogram HistogramMetric::snapshot() {
+	Histogram merged;
+	for ( int i = 0; i < METRICS_SHARDS; i++ ) {
+		lock_guard<mutex> guard(shards[i].lock);
+		if ( shards[i].histogram != NULL ) {
+			merged.merge(*shards[i].histogram);
+		}
+	}
+	return merged;
+}
+
+/**
+ * FUNCTION NAME: expose
+ *
+ * DESCRIPTION: Cumulative _bucket series with le bounds in seconds, then _sum and _count
+ */
+void HistogramMetric::expose(string &out, const string &name, const string &labels) {
+	Histogram h = snapshot();
+	string prefix = labels.empty() ? "" : labels + ",";
+	char le[32];
+	for ( int bits = METRICS_FIRST_LE_BITS; bits <= HIST_MAX_BITS; bits += METRICS_LE_STEP ) {
+		snprintf(le, sizeof(le), "%.9g", (1UL << bits) / 1e9);
+		out += name + "_bucket{" + prefix + "le=\"" + le + "\"} " + to_string(h.countBelow(1UL << bits)) + "\n";
+	}
+	out += name + "_bucket{" + prefix + "le=\"+Inf\"} " + to_string(h.count()) + "\n";
+	snprintf(le, sizeof(le), "%.9f", h.mean() * h.count() / 1e9);
+	out += seriesName(name + "_sum", labels) + " " + le + "\n";
+	out += seriesName(name + "_count", labels) + " " + to_string(h.count()) + "\n";
+}
+
+/**
+ * constructor
+ */
+MetricsRegistry::MetricsRegistry(): stopping(false) {}
+
+/**
+ * Destructor
+ */
+MetricsRegistry::~MetricsRegistry() {
+	stopServer();
+	map<string, Family>::iterator family;
+	for ( family = families.begin(); family != families.end(); family++ ) {
+		map<string, Metric *>::iterator it;
+		for ( it = family->second.series.begin(); it != family->second.series.end(); it++ ) {
+			delete it->second;
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: get
+ *
+ * DESCRIPTION: The series of a family with these labels, created on first use
+ */
+template <class T> T *MetricsRegistry::get(const string &name, const string &help, const char *type, const string &labels) {
+	lock_guard<mutex> guard(lock);
+	Family &family = families[name];
+	if ( family.type.empty() ) {
+		family.help = help;
+		family.type = type;
+	}
+	Metric *&metric = family.series[labels];
+	if ( metric == NULL ) {
+		metric = new T();
+	}
+	return static_cast<T *>(metric);
+}
+
+Counter *MetricsRegistry::counter(const string &name, const string &help, const string &labels) {
+	return get<Counter>(name, help, "counter", labels);
+}
+
+Gauge *MetricsRegistry::gauge(const string &name, const string &help, const string &labels) {
+	return get<Gauge>(name, help, "gauge", labels);
+}
+
+HistogramMetric *MetricsRegistry::histogram(const string &name, const string &help, const string &labels) {
+	return get<HistogramMetric>(name, help, "histogram", labels);
+}
+
+/**
+ * FUNCTION NAME: expose
+ *
+ * DESCRIPTION: Every family in the Prometheus text format, by name
+ */
+string MetricsRegistry::expose() {
+	lock_guard<mutex> guard(lock);
+	string out;
+	map<string, Family>::iterator family;
+	for ( family = families.begin(); family != families.end(); family++ ) {
+		out += "# HELP " + family->first + " " + family->second.help + "\n";
+		out += "# TYPE " + family->first + " " + family->second.type + "\n";
+		map<string, Metric *>::iterator it;
+		for ( it = family->second.series.begin(); it != family->second.series.end(); it++ ) {
+			it->second->expose(out, family->first, it->first);
+		}
+	}
+	return out;
+}
+
+/**
+ * FUNCTION NAME: writeFile
+ *
+ * DESCRIPTION: Write the exposition to path, through a temporary file renamed over it so a
+ * 				scraper never reads half of it
+ *
+ * RETURNS:
+ * true on success
+ */
+bool MetricsRegistry::writeFile(const char *path) {
+	string text = expose();
+	string temporary = string(path) + ".tmp";
+	FILE *file = fopen(temporary.c_str(), "w");
+	if ( file == NULL ) {
+		return false;
+	}
+	bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+	written = (fclose(file) == 0) && written;
+	return written && rename(temporary.c_str(), path) == 0;
+}
+
+/**
+ * FUNCTION NAME: startServer
+ *
+ * DESCRIPTION: Serve the exposition over HTTP on 127.0.0.1:port, from a thread of its own
+ *
+ * RETURNS:
+ * true if the port could be bound
+ */
+bool MetricsRegistry::startServer(int port) {
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+	if ( fd < 0 ) {
+		return false;
+	}
+	int on = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	struct sockaddr_in sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sin_family = AF_INET;
+	sa.sin_port = htons(port);
+	sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if ( bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0 || listen(fd, 16) < 0 ) {
+		close(fd);
+		return false;
+	}
+	stopping = false;
+	server = thread(&MetricsRegistry::serve, this, fd);
+	return true;
+}
+
+/**
+ * FUNCTION NAME: stopServer
+ */
+void MetricsRegistry::stopServer() {
+	if ( server.joinable() ) {
+		stopping = true;
+		server.join();
+	}
+}
+
+/**
+ * FUNCTION NAME: serve
+ *
+ * DESCRIPTION: Answer every connection with the current exposition, whatever the request
+ */
+void MetricsRegistry::serve(int fd) {
+	struct pollfd listener;
+	listener.fd = fd;
+	listener.events = POLLIN;
+	while ( !stopping ) {
+		if ( poll(&listener, 1, METRICS_POLL_MS) <= 0 ) {
+			continue;
+		}
+		int client = accept(fd, NULL, NULL);
+		if ( client < 0 ) {
+			continue;
+		}
+		// the request itself does not matter, but is read when it comes in time
+		struct pollfd request;
+		request.fd = client;
+		request.events = POLLIN;
+		char buffer[1024];
+		if ( poll(&request, 1, METRICS_POLL_MS) > 0 ) {
+			recv(client, buffer, sizeof(buffer), 0);
+		}
+		string body = expose();
+		string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " + to_string(body.size()) + "\r\n\r\n" + body;
+		size_t sent = 0;
+		while ( sent < response.size() ) {
+			ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+			if ( n <= 0 ) {
+				break;
+			}
+			sent += n;
+		}
+		close(client);
+	}
+	close(fd);
+}
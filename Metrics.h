@@ -0,0 +1,171 @@
+/**********************************
+ * FILE NAME: Metrics.h
+ *
+ * DESCRIPTION: Header file of the metrics registry and its Prometheus text exposition
+ **********************************/
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+/*
+ * Macros
+ */
+// shards of a counter or histogram, the threads are spread over them
+#define METRICS_SHARDS 16
+// histogram buckets exported: powers of 2 nanoseconds from 2^METRICS_FIRST_LE_BITS,
+// every METRICS_LE_STEP bits
+#define METRICS_FIRST_LE_BITS 10
+#define METRICS_LE_STEP 2
+// milliseconds the metrics server waits for a connection before checking if it should stop
+#define METRICS_POLL_MS 100
+// bytes of a cache line, the alignment of the shards
+#define METRICS_LINE 64
+
+#include "stdincludes.h"
+#include "Histogram.h"
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <thread>
+
+/**
+ * FUNCTION NAME: metricsShard
+ *
+ * DESCRIPTION: Shard of the calling thread, given round robin to the threads on first use
+ */
+inline int metricsShard() {
+	static atomic<int> nextShard(0);
+	static thread_local int shard = nextShard.fetch_add(1, memory_order_relaxed) % METRICS_SHARDS;
+	return shard;
+}
+
+/**
+ * CLASS NAME: Metric
+ *
+ * DESCRIPTION: A time series of a metric family, along with its labels
+ */
+class Metric {
+public:
+	virtual ~Metric() {}
+	// C++11 new ignores the alignment of the shards, so the metrics allocate their own
+	static void *operator new(size_t size) {
+		void *memory;
+		if ( posix_memalign(&memory, METRICS_LINE, size) != 0 ) {
+			throw bad_alloc();
+		}
+		return memory;
+	}
+	static void operator delete(void *memory) {
+		free(memory);
+	}
+	virtual void expose(string &out, const string &name, const string &labels) = 0;
+};
+
+/**
+ * CLASS NAME: Counter
+ *
+ * DESCRIPTION: Monotonic count, one cache line per shard so the threads adding to it do
+ * 				not contend. Reading it sums the shards.
+ */
+class Counter: public Metric {
+private:
+	struct alignas(METRICS_LINE) Shard {
+		atomic<unsigned long> value;
+	};
+	Shard shards[METRICS_SHARDS];
+public:
+	Counter();
+	void add(unsigned long n = 1) {
+		shards[metricsShard()].value.fetch_add(n, memory_order_relaxed);
+	}
+	unsigned long value();
+	void expose(string &out, const string &name, const string &labels);
+};
+
+/**
+ * CLASS NAME: Gauge
+ *
+ * DESCRIPTION: Value going up and down, set by its owner
+ */
+class Gauge: public Metric {
+private:
+	atomic<long> current;
+public:
+	Gauge(): current(0) {}
+	void set(long value) {
+		current.store(value, memory_order_relaxed);
+	}
+	void add(long n) {
+		current.fetch_add(n, memory_order_relaxed);
+	}
+	long value() {
+		return current.load(memory_order_relaxed);
+	}
+	void expose(string &out, const string &name, const string &labels);
+};
+
+/**
+ * CLASS NAME: HistogramMetric
+ *
+ * DESCRIPTION: Distribution of durations in nanoseconds, exported in seconds.
+ * 				Every shard is a Histogram behind a lock of its own, which only the
+ * 				threads of that shard and the exposition take.
+ */
+class HistogramMetric: public Metric {
+private:
+	struct alignas(METRICS_LINE) Shard {
+		mutex lock;
+		Histogram *histogram;
+	};
+	Shard shards[METRICS_SHARDS];
+public:
+	HistogramMetric();
+	~HistogramMetric();
+	void observe(unsigned long nanos);
+	Histogram snapshot();
+	void expose(string &out, const string &name, const string &labels);
+};
+
+/**
+ * CLASS NAME: MetricsRegistry
+ *
+ * DESCRIPTION: Metric families by name, and their series by labels.
+ * 				The getters create a series on first use and always return the same object
+ * 				for a name and labels, so callers keep the pointer and update it without
+ * 				going through the registry. Labels are given in the exposition syntax,
+ * 				e.g. node="1.0.0.0:0". The registry can be written out as Prometheus text
+ * 				to a file or served over HTTP on a local port.
+ */
+class MetricsRegistry {
+private:
+	struct Family {
+		string help;
+		string type;
+		map<string, Metric *> series;
+	};
+	map<string, Family> families;
+	mutex lock;
+	thread server;
+	atomic<bool> stopping;
+	template <class T> T *get(const string &name, const string &help, const char *type, const string &labels);
+	void serve(int fd);
+public:
+	MetricsRegistry();
+	~MetricsRegistry();
+	Counter *counter(const string &name, const string &help, const string &labels = "");
+	Gauge *gauge(const string &name, const string &help, const string &labels = "");
+	HistogramMetric *histogram(const string &name, const string &help, const string &labels = "");
+	string expose();
+	bool writeFile(const char *path);
+	bool startServer(int port);
+	void stopServer();
+};
+
+/**
+ * FUNCTION NAME: metrics
+ *
+ * DESCRIPTION: The registry of the process
+ */
+MetricsRegistry &metrics();
+
+#endif /* METRICS_H_ */
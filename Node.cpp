@@ -27,10 +27,10 @@ Node::~Node() {}
 /**
  * FUNCTION NAME: computeHashCode
  *
- * DESCRIPTION: This function computes the hash code of the node address
+ * DESCRIPTION: This function computes the hash code of the node address, all of its bytes
  */
 void Node::computeHashCode() {
-	nodeHashCode = hashFunc(nodeAddress.addr)%RING_SIZE;
+	nodeHashCode = hash64(nodeAddress.addr, sizeof(nodeAddress.addr))%RING_SIZE;
 }
 
 /**
@@ -54,7 +54,18 @@ Node& Node::operator=(const Node& another) {
  * operator overloading
  */
 bool Node::operator < (const Node& another) const {
-	return this->nodeHashCode < another.nodeHashCode;
+	if ( this->nodeHashCode != another.nodeHashCode ) {
+		return this->nodeHashCode < another.nodeHashCode;
+	}
+	// nodes hashed to the same position are ordered by address, so that every node builds
+	// the same ring whatever the order they joined in
+	int id, anotherId;
+	short port, anotherPort;
+	memcpy(&id, &this->nodeAddress.addr[0], sizeof(int));
+	memcpy(&anotherId, &another.nodeAddress.addr[0], sizeof(int));
+	memcpy(&port, &this->nodeAddress.addr[4], sizeof(short));
+	memcpy(&anotherPort, &another.nodeAddress.addr[4], sizeof(short));
+	return id < anotherId || (id == anotherId && port < anotherPort);
 }
 
 /**
@@ -5,11 +5,24 @@
  **********************************/
 
 #include "Params.h"
+#include "Log.h"
 
 /**
  * Constructor
  */
-Params::Params(): PORTNUM(8001) {}
+Params::Params(): NODE_OFFSET(0), GROUP_SIZE(0), TICK_MS(0), PORTNUM(8001), TRANSPORT(EMULNET_TRANSPORT), UDP_BASE_PORT(20000), UDP_IO(EPOLL_IO), SHM_SLOTS(1024), MEMBERSHIP(GOSSIP_MEMBERSHIP), PARTITIONER(RING_PARTITIONER), REBALANCE(0), LOG_FORMAT(TEXT_LOG), LOG_LEVEL(LOG_LEVEL_DEBUG), STATS_PERIOD(100), METRICS_PORT(0),
+		WORKLOAD(NO_WORKLOAD), WORKLOAD_RECORDS(1000), WORKLOAD_OPERATIONS(10000), WORKLOAD_READ(-1), WORKLOAD_UPDATE(-1), WORKLOAD_INSERT(-1), WORKLOAD_SCAN(-1), WORKLOAD_RMW(-1),
+		WORKLOAD_DISTRIBUTION(-1), WORKLOAD_ZIPF(0.99), WORKLOAD_SCAN_LENGTH(100), WORKLOAD_VALUE_DISTRIBUTION(FIXED_DISTRIBUTION), WORKLOAD_VALUE_MIN(100), WORKLOAD_VALUE_MAX(100), WORKLOAD_RATE(100),
+		REPLAY_SPEED(1), SEED(0), BENCH_PERIOD(10) {
+	strcpy(UDP_HOST, "127.0.0.1");
+	strcpy(SHM_NAME, "/kvstore");
+	METRICS_FILE[0] = 0;
+	TRACE_FILE[0] = 0;
+	RECORD_FILE[0] = 0;
+	REPLAY_FILE[0] = 0;
+	SCHEDULE_FILE[0] = 0;
+	BENCH_FILE[0] = 0;
+}
 
 /**
  * FUNCTION NAME: setparams
@@ -19,6 +32,8 @@ Params::Params(): PORTNUM(8001) {}
 void Params::setparams(char *config_file) {
 	//trace.funcEntry("Params::setparams");
 	char CRUD[10];
+	char key[64];
+	char value[256];
 	FILE *fp = fopen(config_file,"r");
 
 	fscanf(fp,"MAX_NNB: %d", &MAX_NNB);
@@ -40,9 +55,17 @@ void Params::setparams(char *config_file) {
 		this->CRUDTEST = DELETE_TEST;
 	}
 
+	// Optional "KEY: value" lines following the mandatory ones
+	while ( fscanf(fp, " %63[^:]: %255s", key, value) == 2 ) {
+		setparam(key, value);
+	}
+
 	//printf("Parameters of the test case: %d %d %d %lf\n", MAX_NNB, SINGLE_FAILURE, DROP_MSG, MSG_DROP_PROB);
 
 	EN_GPSZ = MAX_NNB;
+	if ( GROUP_SIZE < NODE_OFFSET + EN_GPSZ ) {
+		GROUP_SIZE = NODE_OFFSET + EN_GPSZ;
+	}
 	STEP_RATE=.25;
 	MAX_MSG_SIZE = 4000;
 	globaltime = 0;
@@ -56,6 +79,217 @@ void Params::setparams(char *config_file) {
 	return;
 }
 
+/**
+ * FUNCTION NAME: distributionOf
+ *
+ * DESCRIPTION: Distribution named by value, FIXED_DISTRIBUTION when unknown
+ */
+static int distributionOf(char *value) {
+	if ( 0 == strcmp(value, "ZIPFIAN") ) {
+		return ZIPFIAN_DISTRIBUTION;
+	}
+	if ( 0 == strcmp(value, "UNIFORM") ) {
+		return UNIFORM_DISTRIBUTION;
+	}
+	if ( 0 == strcmp(value, "LATEST") ) {
+		return LATEST_DISTRIBUTION;
+	}
+	return FIXED_DISTRIBUTION;
+}
+
+/**
+ * FUNCTION NAME: setparam
+ *
+ * DESCRIPTION: Set one optional parameter of the test case. Unknown keys are ignored.
+ */
+void Params::setparam(char *key, char *value) {
+	if ( 0 == strcmp(key, "TRANSPORT") ) {
+		if ( 0 == strcmp(value, "UDP") ) {
+			this->TRANSPORT = UDP_TRANSPORT;
+		}
+		else if ( 0 == strcmp(value, "SHM") ) {
+			this->TRANSPORT = SHM_TRANSPORT;
+		}
+		else {
+			this->TRANSPORT = EMULNET_TRANSPORT;
+		}
+	}
+	else if ( 0 == strcmp(key, "NODE_OFFSET") ) {
+		this->NODE_OFFSET = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "GROUP_SIZE") ) {
+		this->GROUP_SIZE = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "TICK_MS") ) {
+		this->TICK_MS = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "UDP_HOST") ) {
+		strncpy(this->UDP_HOST, value, sizeof(this->UDP_HOST) - 1);
+		this->UDP_HOST[sizeof(this->UDP_HOST) - 1] = 0;
+	}
+	else if ( 0 == strcmp(key, "UDP_BASE_PORT") ) {
+		this->UDP_BASE_PORT = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "UDP_IO") ) {
+		if ( 0 == strcmp(value, "URING") ) {
+			this->UDP_IO = URING_IO;
+		}
+		else {
+			this->UDP_IO = EPOLL_IO;
+		}
+	}
+	else if ( 0 == strcmp(key, "SHM_NAME") ) {
+		strncpy(this->SHM_NAME, value, sizeof(this->SHM_NAME) - 1);
+		this->SHM_NAME[sizeof(this->SHM_NAME) - 1] = 0;
+	}
+	else if ( 0 == strcmp(key, "SHM_SLOTS") ) {
+		this->SHM_SLOTS = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "MEMBERSHIP") ) {
+		if ( 0 == strcmp(value, "SWIM") ) {
+			this->MEMBERSHIP = SWIM_MEMBERSHIP;
+		}
+		else {
+			this->MEMBERSHIP = GOSSIP_MEMBERSHIP;
+		}
+	}
+	else if ( 0 == strcmp(key, "PARTITIONER") ) {
+		if ( 0 == strcmp(value, "JUMP") ) {
+			this->PARTITIONER = JUMP_PARTITIONER;
+		}
+		else if ( 0 == strcmp(value, "RENDEZVOUS") ) {
+			this->PARTITIONER = RENDEZVOUS_PARTITIONER;
+		}
+		else {
+			this->PARTITIONER = RING_PARTITIONER;
+		}
+	}
+	else if ( 0 == strcmp(key, "NODE_WEIGHT") ) {
+		// id=weight, one line per node
+		char *weight = strchr(value, '=');
+		if ( weight != NULL ) {
+			this->NODE_WEIGHTS[atoi(value)] = atof(weight + 1);
+		}
+	}
+	else if ( 0 == strcmp(key, "REBALANCE") ) {
+		this->REBALANCE = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "LOG_FORMAT") ) {
+		if ( 0 == strcmp(value, "BINARY") ) {
+			this->LOG_FORMAT = BINARY_LOG;
+		}
+		else {
+			this->LOG_FORMAT = TEXT_LOG;
+		}
+	}
+	else if ( 0 == strcmp(key, "LOG_LEVEL") ) {
+		if ( 0 == strcmp(value, "EVENT") ) {
+			this->LOG_LEVEL = LOG_LEVEL_EVENT;
+		}
+		else if ( 0 == strcmp(value, "SERVER") ) {
+			this->LOG_LEVEL = LOG_LEVEL_SERVER;
+		}
+		else {
+			this->LOG_LEVEL = LOG_LEVEL_DEBUG;
+		}
+	}
+	else if ( 0 == strcmp(key, "STATS_PERIOD") ) {
+		this->STATS_PERIOD = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "METRICS_FILE") ) {
+		strncpy(this->METRICS_FILE, value, sizeof(this->METRICS_FILE) - 1);
+		this->METRICS_FILE[sizeof(this->METRICS_FILE) - 1] = 0;
+	}
+	else if ( 0 == strcmp(key, "METRICS_PORT") ) {
+		this->METRICS_PORT = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "TRACE_FILE") ) {
+		strncpy(this->TRACE_FILE, value, sizeof(this->TRACE_FILE) - 1);
+		this->TRACE_FILE[sizeof(this->TRACE_FILE) - 1] = 0;
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD") ) {
+		if ( strlen(value) == 1 && value[0] >= 'A' && value[0] <= 'F' ) {
+			this->WORKLOAD = WORKLOAD_A + (value[0] - 'A');
+		}
+		else if ( 0 == strcmp(value, "CUSTOM") ) {
+			this->WORKLOAD = CUSTOM_WORKLOAD;
+		}
+		else {
+			this->WORKLOAD = NO_WORKLOAD;
+		}
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD_RECORDS") ) {
+		this->WORKLOAD_RECORDS = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD_OPERATIONS") ) {
+		this->WORKLOAD_OPERATIONS = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD_READ") ) {
+		this->WORKLOAD_READ = atof(value);
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD_UPDATE") ) {
+		this->WORKLOAD_UPDATE = atof(value);
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD_INSERT") ) {
+		this->WORKLOAD_INSERT = atof(value);
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD_SCAN") ) {
+		this->WORKLOAD_SCAN = atof(value);
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD_RMW") ) {
+		this->WORKLOAD_RMW = atof(value);
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD_DISTRIBUTION") ) {
+		this->WORKLOAD_DISTRIBUTION = distributionOf(value);
+		if ( this->WORKLOAD_DISTRIBUTION == FIXED_DISTRIBUTION ) {
+			this->WORKLOAD_DISTRIBUTION = ZIPFIAN_DISTRIBUTION;
+		}
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD_ZIPF") ) {
+		this->WORKLOAD_ZIPF = atof(value);
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD_SCAN_LENGTH") ) {
+		this->WORKLOAD_SCAN_LENGTH = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD_VALUE_DISTRIBUTION") ) {
+		this->WORKLOAD_VALUE_DISTRIBUTION = distributionOf(value);
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD_VALUE_MIN") ) {
+		this->WORKLOAD_VALUE_MIN = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD_VALUE_MAX") ) {
+		this->WORKLOAD_VALUE_MAX = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "WORKLOAD_RATE") ) {
+		this->WORKLOAD_RATE = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "RECORD_FILE") ) {
+		strncpy(this->RECORD_FILE, value, sizeof(this->RECORD_FILE) - 1);
+		this->RECORD_FILE[sizeof(this->RECORD_FILE) - 1] = 0;
+	}
+	else if ( 0 == strcmp(key, "REPLAY_FILE") ) {
+		strncpy(this->REPLAY_FILE, value, sizeof(this->REPLAY_FILE) - 1);
+		this->REPLAY_FILE[sizeof(this->REPLAY_FILE) - 1] = 0;
+	}
+	else if ( 0 == strcmp(key, "REPLAY_SPEED") ) {
+		this->REPLAY_SPEED = atof(value);
+	}
+	else if ( 0 == strcmp(key, "SEED") ) {
+		this->SEED = strtoul(value, NULL, 10);
+	}
+	else if ( 0 == strcmp(key, "SCHEDULE_FILE") ) {
+		strncpy(this->SCHEDULE_FILE, value, sizeof(this->SCHEDULE_FILE) - 1);
+		this->SCHEDULE_FILE[sizeof(this->SCHEDULE_FILE) - 1] = 0;
+	}
+	else if ( 0 == strcmp(key, "BENCH_FILE") ) {
+		strncpy(this->BENCH_FILE, value, sizeof(this->BENCH_FILE) - 1);
+		this->BENCH_FILE[sizeof(this->BENCH_FILE) - 1] = 0;
+	}
+	else if ( 0 == strcmp(key, "BENCH_PERIOD") ) {
+		this->BENCH_PERIOD = atoi(value);
+	}
+}
+
 /**
  * FUNCTION NAME: getcurrtime
  *
@@ -10,9 +10,20 @@
 #include "stdincludes.h"
 #include "Params.h"
 #include "Member.h"
+#include "common.h"
 
 enum testTYPE { CREATE_TEST, READ_TEST, UPDATE_TEST, DELETE_TEST };
 
+enum transportTYPE { EMULNET_TRANSPORT, UDP_TRANSPORT, SHM_TRANSPORT };
+
+enum ioTYPE { EPOLL_IO, URING_IO };
+
+enum logFORMAT { TEXT_LOG, BINARY_LOG };
+
+enum workloadTYPE { NO_WORKLOAD, WORKLOAD_A, WORKLOAD_B, WORKLOAD_C, WORKLOAD_D, WORKLOAD_E, WORKLOAD_F, CUSTOM_WORKLOAD };
+
+enum distributionTYPE { ZIPFIAN_DISTRIBUTION, UNIFORM_DISTRIBUTION, LATEST_DISTRIBUTION, FIXED_DISTRIBUTION };
+
 /**
  * CLASS NAME: Params
  *
@@ -25,6 +36,9 @@ public:
 	double MSG_DROP_PROB;		// message drop probability
 	double STEP_RATE;		    // dictates the rate of insertion
 	int EN_GPSZ;			    // actual number of peers
+	int NODE_OFFSET;            // the nodes of this process have the ids NODE_OFFSET + 1 to NODE_OFFSET + EN_GPSZ
+	int GROUP_SIZE;             // nodes of the deployment across all its processes
+	int TICK_MS;                // wall clock milliseconds of a tick, 0 to run the ticks back to back
 	int MAX_MSG_SIZE;
 	int DROP_MSG;
 	int dropmsg;
@@ -32,8 +46,47 @@ public:
 	int allNodesJoined;
 	short PORTNUM;
 	int CRUDTEST;
+	int TRANSPORT;              // network backend used by the nodes
+	char UDP_HOST[16];          // host the UDP backend binds and sends to
+	int UDP_BASE_PORT;          // node id N of channel C listens on UDP_BASE_PORT + C*MAX_NODES + N
+	int UDP_IO;                 // event loop of the UDP backend
+	char SHM_NAME[64];          // prefix of the shared memory segments of the SHM backend
+	int SHM_SLOTS;              // slots per destination ring of the SHM backend
+	int MEMBERSHIP;             // membership protocol run by MP1Node
+	int PARTITIONER;            // placement of the keys on the nodes of the ring
+	map<int, double> NODE_WEIGHTS; // weights of the nodes by id for the rendezvous partitioner, 1 when not given
+	int REBALANCE;              // ticks between two load-aware rebalancing rounds, 0 to disable
+	int LOG_FORMAT;             // dbg.log and stats.log text or dbg.bin binary event log
+	int LOG_LEVEL;              // lowest log level written, among the ones compiled in
+	int STATS_PERIOD;           // ticks between two latency and throughput reports in stats.log, 0 to disable
+	char METRICS_FILE[256];     // file the metrics are written to every STATS_PERIOD ticks and at the end, empty to disable
+	int METRICS_PORT;           // local port the metrics are served on over HTTP, 0 to disable
+	char TRACE_FILE[256];       // file the trace spans of the run are dumped to as Chrome trace JSON, empty to disable
+	int WORKLOAD;               // YCSB workload driven by the application instead of the CRUD test
+	int WORKLOAD_RECORDS;       // records inserted by the load phase of the workload
+	int WORKLOAD_OPERATIONS;    // operations of the run phase of the workload
+	double WORKLOAD_READ;       // proportions of the run phase operations, negative for the ones of the workload
+	double WORKLOAD_UPDATE;
+	double WORKLOAD_INSERT;
+	double WORKLOAD_SCAN;
+	double WORKLOAD_RMW;
+	int WORKLOAD_DISTRIBUTION;  // popularity of the records, negative for the one of the workload
+	double WORKLOAD_ZIPF;       // zipfian constant of the record popularity and value sizes
+	int WORKLOAD_SCAN_LENGTH;   // records read by a scan at most
+	int WORKLOAD_VALUE_DISTRIBUTION; // value sizes between WORKLOAD_VALUE_MIN and WORKLOAD_VALUE_MAX
+	int WORKLOAD_VALUE_MIN;
+	int WORKLOAD_VALUE_MAX;
+	int WORKLOAD_RATE;          // workload operations issued per tick
+	char RECORD_FILE[256];      // file the client operations are recorded to, empty to disable
+	char REPLAY_FILE[256];      // client trace replayed instead of the CRUD test or workload, empty to disable
+	double REPLAY_SPEED;        // speedup of the replay over the recorded ticks
+	unsigned int SEED;          // seed of the random number generator, 0 for one from the clock
+	char SCHEDULE_FILE[256];    // failure schedule run along, empty for none
+	char BENCH_FILE[256];       // file the CSV benchmark report is written to, empty to disable
+	int BENCH_PERIOD;           // ticks between two rows of the benchmark report
 	Params();
 	void setparams(char *);
+	void setparam(char *key, char *value);
 	int getcurrtime();
 };
 
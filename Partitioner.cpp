@@ -0,0 +1,264 @@
+/**********************************
+ * FILE NAME: Partitioner.cpp
+ *
+ * DESCRIPTION: Definition of the partitioners
+ **********************************/
+
+#include "Partitioner.h"
+#include "Params.h"
+
+/**
+ * FUNCTION NAME: create
+ *
+ * DESCRIPTION: Partitioner of the given partitionerTYPE
+ */
+Partitioner *Partitioner::create(int type) {
+	if ( type == JUMP_PARTITIONER ) {
+		return new JumpPartitioner();
+	}
+	if ( type == RENDEZVOUS_PARTITIONER ) {
+		return new RendezvousPartitioner();
+	}
+	return new RingPartitioner();
+}
+
+/**
+ * FUNCTION NAME: setNodes
+ *
+ * DESCRIPTION: Take the nodes of a new ring
+ */
+void Partitioner::setNodes(const vector<Node> &ring) {
+	nodes = ring;
+}
+
+/**
+ * FUNCTION NAME: replicasOf
+ *
+ * DESCRIPTION: Binary search of the position of the key on the ring.
+ * 				Past the last node the ring wraps around to the first one.
+ */
+vector<Node> RingPartitioner::replicasOf(uint64_t keyHash) {
+	vector<Node> replicas;
+	if ( nodes.size() < REPLICATION_FACTOR ) {
+		return replicas;
+	}
+	size_t pos = keyHash % RING_SIZE;
+	size_t lo = 0, hi = nodes.size();
+	while ( lo < hi ) {
+		size_t mid = (lo + hi) / 2;
+		if ( nodes[mid].nodeHashCode < pos ) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	for ( int i = 0; i < REPLICATION_FACTOR; i++ ) {
+		replicas.push_back(nodes[(lo + i) % nodes.size()]);
+	}
+	return replicas;
+}
+
+/**
+ * FUNCTION NAME: update
+ *
+ * DESCRIPTION: Place every partition with the partitioner, which was handed the new ring.
+ * 				Partition p is placed as a key hashed to p: PARTITIONS being a multiple of
+ * 				RING_SIZE and JUMP_PARTITIONS, the ring and jump placements of a key do not
+ * 				change by going through its partition.
+ * 				A move applies while its source still holds the partition and its
+ * 				destination is on the ring and does not hold it yet.
+ *
+ * RETURNS:
+ * the partitions whose replica set changed
+ */
+vector<int> PartitionMap::update(Partitioner *partitioner, vector<Node> &ring, const map<int, PartitionMove> &moves) {
+	vector<int> moved;
+	for ( int p = 0; p < PARTITIONS; p++ ) {
+		vector<Node> placed = partitioner->replicasOf(p);
+		map<int, PartitionMove>::const_iterator move = moves.find(p);
+		if ( move != moves.end() ) {
+			int from = -1, to = -1;
+			bool held = false;
+			for ( size_t i = 0; i < placed.size(); i++ ) {
+				if ( memcmp(placed[i].nodeAddress.addr, move->second.from.addr, sizeof(move->second.from.addr)) == 0 ) {
+					from = i;
+				}
+				if ( memcmp(placed[i].nodeAddress.addr, move->second.to.addr, sizeof(move->second.to.addr)) == 0 ) {
+					held = true;
+				}
+			}
+			for ( size_t i = 0; from >= 0 && !held && i < ring.size(); i++ ) {
+				if ( memcmp(ring[i].nodeAddress.addr, move->second.to.addr, sizeof(move->second.to.addr)) == 0 ) {
+					to = i;
+				}
+			}
+			if ( from >= 0 && to >= 0 ) {
+				placed[from] = ring[to];
+			}
+		}
+		bool same = placed.size() == replicas[p].size();
+		for ( size_t i = 0; same && i < placed.size(); i++ ) {
+			same = memcmp(placed[i].nodeAddress.addr, replicas[p][i].nodeAddress.addr, sizeof(placed[i].nodeAddress.addr)) == 0;
+		}
+		if ( !same ) {
+			replicas[p] = placed;
+			moved.push_back(p);
+		}
+	}
+	return moved;
+}
+
+/**
+ * FUNCTION NAME: isReplica
+ *
+ * DESCRIPTION: Whether the node at address holds partition
+ */
+bool PartitionMap::isReplica(int partition, Address &address) {
+	for ( size_t i = 0; i < replicas[partition].size(); i++ ) {
+		if ( memcmp(replicas[partition][i].nodeAddress.addr, address.addr, sizeof(address.addr)) == 0 ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * FUNCTION NAME: jump
+ *
+ * DESCRIPTION: Bucket in [0, buckets) of key
+ */
+int JumpPartitioner::jump(uint64_t key, int buckets) {
+	long b = -1, j = 0;
+	while ( j < buckets ) {
+		b = j;
+		key = key * 2862933555777941757ULL + 1;
+		j = (long)((b + 1) * ((double)(1LL << 31) / (double)((key >> 33) + 1)));
+	}
+	return (int)b;
+}
+
+/**
+ * FUNCTION NAME: idOf
+ */
+int JumpPartitioner::idOf(const Node &node) {
+	int id;
+	memcpy(&id, &node.nodeAddress.addr[0], sizeof(int));
+	return id;
+}
+
+/**
+ * FUNCTION NAME: setNodes
+ *
+ * DESCRIPTION: Take the nodes of a new ring, in id order, and work out the owner of every
+ * 				partition over the buckets of ids 1 to the largest one on the ring
+ */
+void JumpPartitioner::setNodes(const vector<Node> &ring) {
+	nodes = ring;
+	sort(nodes.begin(), nodes.end(), [](const Node &a, const Node &b) {
+		return idOf(a) < idOf(b);
+	});
+	owners.assign(JUMP_PARTITIONS, 0);
+	if ( nodes.empty() || idOf(nodes.back()) < 1 ) {
+		return;
+	}
+	int buckets = idOf(nodes.back());
+	vector<int> nodeOf(buckets, -1);
+	for ( size_t i = 0; i < nodes.size(); i++ ) {
+		if ( idOf(nodes[i]) >= 1 ) {
+			nodeOf[idOf(nodes[i]) - 1] = i;
+		}
+	}
+	for ( uint64_t p = 0; p < JUMP_PARTITIONS; p++ ) {
+		uint64_t key = hash64(&p, sizeof(p));
+		int bucket = jump(key, buckets);
+		for ( uint64_t attempt = 1; nodeOf[bucket] < 0 && attempt <= JUMP_ATTEMPTS; attempt++ ) {
+			bucket = jump(hashMix(key ^ hashSecret[3], attempt), buckets);
+		}
+		while ( nodeOf[bucket] < 0 ) {
+			bucket = (bucket + 1) % buckets;
+		}
+		owners[p] = nodeOf[bucket];
+	}
+}
+
+/**
+ * FUNCTION NAME: replicasOf
+ */
+vector<Node> JumpPartitioner::replicasOf(uint64_t keyHash) {
+	vector<Node> replicas;
+	if ( nodes.size() < REPLICATION_FACTOR ) {
+		return replicas;
+	}
+	int owner = owners[keyHash % JUMP_PARTITIONS];
+	for ( int i = 0; i < REPLICATION_FACTOR; i++ ) {
+		replicas.push_back(nodes[(owner + i) % nodes.size()]);
+	}
+	return replicas;
+}
+
+/**
+ * FUNCTION NAME: setNodes
+ *
+ * DESCRIPTION: Take the nodes of a new ring along with the hash and weight of each one
+ */
+void RendezvousPartitioner::setNodes(const vector<Node> &ring) {
+	nodes = ring;
+	nodeHashes.clear();
+	weights.clear();
+	for ( size_t i = 0; i < nodes.size(); i++ ) {
+		Address *address = nodes[i].getAddress();
+		nodeHashes.push_back(hash64(address->addr, sizeof(address->addr)));
+		int id;
+		memcpy(&id, &address->addr[0], sizeof(int));
+		map<int, double>::iterator search = weightOf.find(id);
+		weights.push_back(search == weightOf.end() ? 1.0 : search->second);
+	}
+}
+
+/**
+ * FUNCTION NAME: setWeight
+ *
+ * DESCRIPTION: Give node id a share of the keys proportional to weight.
+ * 				Applies from the next setNodes.
+ */
+void RendezvousPartitioner::setWeight(int id, double weight) {
+	weightOf[id] = weight;
+}
+
+/**
+ * FUNCTION NAME: replicasOf
+ *
+ * DESCRIPTION: Score every node and keep the REPLICATION_FACTOR best ones, best first
+ */
+vector<Node> RendezvousPartitioner::replicasOf(uint64_t keyHash) {
+	vector<Node> replicas;
+	if ( nodes.size() < REPLICATION_FACTOR ) {
+		return replicas;
+	}
+	int best[REPLICATION_FACTOR];
+	double bestScore[REPLICATION_FACTOR];
+	int found = 0;
+	for ( size_t i = 0; i < nodes.size(); i++ ) {
+		uint64_t h = hashMix(keyHash ^ hashSecret[2], nodeHashes[i]);
+		// uniform in (0, 1)
+		double u = ((h >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+		double score = -weights[i] / log(u);
+		int j = found < REPLICATION_FACTOR ? found++ : REPLICATION_FACTOR;
+		while ( j > 0 && bestScore[j - 1] < score ) {
+			if ( j < REPLICATION_FACTOR ) {
+				best[j] = best[j - 1];
+				bestScore[j] = bestScore[j - 1];
+			}
+			j--;
+		}
+		if ( j < REPLICATION_FACTOR ) {
+			best[j] = i;
+			bestScore[j] = score;
+		}
+	}
+	for ( int i = 0; i < REPLICATION_FACTOR; i++ ) {
+		replicas.push_back(nodes[best[i]]);
+	}
+	return replicas;
+}
@@ -0,0 +1,132 @@
+/**********************************
+ * FILE NAME: Partitioner.h
+ *
+ * DESCRIPTION: Header file of the partitioners that map a key to its replicas
+ **********************************/
+
+#ifndef PARTITIONER_H_
+#define PARTITIONER_H_
+
+/*
+ * Macros
+ */
+// copies kept of every key
+#define REPLICATION_FACTOR 3
+// fixed partitions the keys are spread over by the jump partitioner
+#define JUMP_PARTITIONS 1024
+// jumps of a partition landing on the buckets of nodes off the ring before taking the next node
+#define JUMP_ATTEMPTS 32
+
+#include "stdincludes.h"
+#include "common.h"
+#include "Node.h"
+#include "Hash.h"
+
+/**
+ * CLASS NAME: Partitioner
+ *
+ * DESCRIPTION: Maps the 64 bit hash of a key to the REPLICATION_FACTOR nodes holding it.
+ * 				setNodes hands over the current ring, sorted by hash code; a lookup with
+ * 				fewer nodes than REPLICATION_FACTOR finds no replica.
+ */
+class Partitioner {
+protected:
+	vector<Node> nodes;
+public:
+	virtual ~Partitioner() {}
+	virtual void setNodes(const vector<Node> &ring);
+	virtual void setWeight(int id, double weight) {}
+	virtual vector<Node> replicasOf(uint64_t keyHash) = 0;
+	virtual const char *name() = 0;
+	static Partitioner *create(int type);
+};
+
+/**
+ * CLASS NAME: RingPartitioner
+ *
+ * DESCRIPTION: Consistent hashing: the replicas are the first node at or after the
+ * 				position of the key on the ring and its two successors.
+ */
+class RingPartitioner : public Partitioner {
+public:
+	vector<Node> replicasOf(uint64_t keyHash);
+	const char *name() { return "ring"; }
+};
+
+/**
+ * CLASS NAME: JumpPartitioner
+ *
+ * DESCRIPTION: Jump consistent hash (Lamping and Veach).
+ * 				A key belongs to one of JUMP_PARTITIONS partitions and the jump hash of
+ * 				the partition picks its first replica among the nodes, the next two nodes
+ * 				in id order hold the other copies. The owner of every partition is worked
+ * 				out once per ring change, so a lookup is an array access.
+ * 				Jump hash moves the fewest partitions when buckets are added at the end of
+ * 				the bucket list. Node ids are handed out in join order, so bucket id - 1
+ * 				belongs to node id: a node joining with a new id adds the last bucket, and
+ * 				the bucket of a node off the ring is kept, its partitions jumping again
+ * 				until they land on a node. A departure then only moves the partitions of
+ * 				the node that left, which get back to it when it rejoins.
+ */
+class JumpPartitioner : public Partitioner {
+private:
+	vector<int> owners;
+	static int idOf(const Node &node);
+public:
+	static int jump(uint64_t key, int buckets);
+	void setNodes(const vector<Node> &ring);
+	vector<Node> replicasOf(uint64_t keyHash);
+	const char *name() { return "jump"; }
+};
+
+/**
+ * CLASS NAME: RendezvousPartitioner
+ *
+ * DESCRIPTION: Weighted rendezvous (highest random weight) hashing.
+ * 				Every node draws a score -weight/ln(u) from the hash u of the pair
+ * 				(key, node) and the REPLICATION_FACTOR best scores hold the key, so
+ * 				removing a node only moves the keys it held.
+ * 				Nodes weigh 1 unless setWeight says otherwise (see NODE_WEIGHT).
+ */
+class RendezvousPartitioner : public Partitioner {
+private:
+	vector<uint64_t> nodeHashes;
+	vector<double> weights;
+	map<int, double> weightOf;
+public:
+	void setNodes(const vector<Node> &ring);
+	void setWeight(int id, double weight);
+	vector<Node> replicasOf(uint64_t keyHash);
+	const char *name() { return "rendezvous"; }
+};
+
+/**
+ * CLASS NAME: PartitionMove
+ *
+ * DESCRIPTION: Replica of a partition handed from one node to another by the rebalancer
+ */
+struct PartitionMove {
+	Address from;
+	Address to;
+};
+
+/**
+ * CLASS NAME: PartitionMap
+ *
+ * DESCRIPTION: Replica set of every one of the PARTITIONS partitions of the keyspace.
+ * 				Every node derives the same map from the same ring, so the map is
+ * 				replicated without being sent around. A key is looked up through its
+ * 				partition, which is also the unit moved when the ring changes.
+ * 				The moves of the rebalancer are applied over the placement of the partitioner.
+ */
+class PartitionMap {
+private:
+	vector<vector<Node> > replicas;
+public:
+	PartitionMap(): replicas(PARTITIONS) {}
+	vector<int> update(Partitioner *partitioner, vector<Node> &ring, const map<int, PartitionMove> &moves);
+	const vector<Node> &replicasOf(int partition) { return replicas[partition]; }
+	bool isReplica(int partition, Address &address);
+};
+
+#endif /* PARTITIONER_H_ */
@@ -0,0 +1,106 @@
+/**********************************
+ * FILE NAME: RangeStream.cpp
+ *
+ * DESCRIPTION: Definition of the range transfer stream codec
+ **********************************/
+
+#include "RangeStream.h"
+
+/**
+ * FUNCTION NAME: fits
+ *
+ * DESCRIPTION: Whether the record of key and value fits alone in a chunk of maxChunkSize bytes
+ */
+bool RangeStream::fits(const string &key, const string &value, int maxChunkSize) {
+	string lengths;
+	putVarint(lengths, 0);
+	putVarint(lengths, key.size());
+	putVarint(lengths, value.size());
+	return (long)(lengths.size() + key.size() + value.size()) <= maxChunkSize;
+}
+
+/**
+ * FUNCTION NAME: encode
+ *
+ * DESCRIPTION: Cut a sorted key run into chunks of at most maxChunkSize bytes.
+ * 				A record that does not fit in a chunk of its own is left out, as the
+ * 				transport could not carry it (see fits).
+ */
+vector<string> RangeStream::encode(const vector<pair<string, string> > &sorted, int maxChunkSize) {
+	vector<string> chunks;
+	string chunk;
+	string prev;
+
+	for ( size_t i = 0; i < sorted.size(); i++ ) {
+		const string &key = sorted[i].first;
+		const string &value = sorted[i].second;
+		if ( !fits(key, value, maxChunkSize) ) {
+			continue;
+		}
+
+		size_t shared = 0;
+		if ( !chunk.empty() ) {
+			while ( shared < prev.size() && shared < key.size() && prev[shared] == key[shared] ) {
+				shared++;
+			}
+		}
+		string record;
+		putVarint(record, shared);
+		putVarint(record, key.size() - shared);
+		record.append(key, shared, string::npos);
+		putVarint(record, value.size());
+		record.append(value);
+
+		if ( !chunk.empty() && (int)(chunk.size() + record.size()) > maxChunkSize ) {
+			chunks.push_back(chunk);
+			chunk.clear();
+			// Start the new chunk with the whole key
+			record.clear();
+			putVarint(record, 0);
+			putVarint(record, key.size());
+			record.append(key);
+			putVarint(record, value.size());
+			record.append(value);
+		}
+		chunk.append(record);
+		prev = key;
+	}
+	if ( !chunk.empty() ) {
+		chunks.push_back(chunk);
+	}
+	return chunks;
+}
+
+/**
+ * FUNCTION NAME: decode
+ *
+ * DESCRIPTION: Append the records of a chunk to records
+ *
+ * RETURNS:
+ * false if the chunk is malformed
+ */
+bool RangeStream::decode(const string &chunk, vector<pair<string, string> > &records) {
+	const char *data = chunk.data();
+	int size = chunk.size();
+	int pos = 0;
+	string prev;
+
+	while ( pos < size ) {
+		unsigned long shared, keylen, valuelen;
+		if ( !getVarint(data, size, pos, shared) || shared > prev.size() ) {
+			return false;
+		}
+		if ( !getVarint(data, size, pos, keylen) || keylen > (unsigned long)(size - pos) ) {
+			return false;
+		}
+		string key = prev.substr(0, shared) + string(data + pos, keylen);
+		pos += keylen;
+		if ( !getVarint(data, size, pos, valuelen) || valuelen > (unsigned long)(size - pos) ) {
+			return false;
+		}
+		records.push_back(make_pair(key, string(data + pos, valuelen)));
+		pos += valuelen;
+		prev = key;
+	}
+	return true;
+}
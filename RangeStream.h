@@ -0,0 +1,85 @@
+/**********************************
+ * FILE NAME: RangeStream.h
+ *
+ * DESCRIPTION: Header file of the range transfer streams of the stabilization protocol
+ **********************************/
+
+#ifndef RANGESTREAM_H_
+#define RANGESTREAM_H_
+
+/*
+ * Macros
+ */
+// Chunks in flight per stream
+#define STREAM_WINDOW 8
+// Ticks without an acknowledgement before the unacknowledged chunks are sent again
+#define STREAM_TIMEOUT 4
+// Ticks after which the snapshot of a stream is read again, and its chunks refused by receivers
+#define STREAM_MAX_AGE 100
+// Timeouts in a row before a stream is abandoned
+#define STREAM_RETRIES 5
+// Room left in every chunk for the header of the STREAMDATA message
+#define STREAM_HEADROOM 64
+
+#include "stdincludes.h"
+#include <set>
+#include "Member.h"
+#include "Varint.h"
+
+/**
+ * CLASS NAME: OutStream
+ *
+ * DESCRIPTION: Sender side of a range transfer: the chunks of a sorted key run bound
+ * 				for one node, read at tick snapshot, with at most STREAM_WINDOW chunks in
+ * 				flight. Acknowledgements are cumulative plus a mask of the chunks received
+ * 				past the cumulative one, so only the missing chunks are sent again.
+ */
+class OutStream {
+public:
+	int id;
+	Address to;
+	vector<string> chunks;
+	int snapshot;
+	// chunks [0, acked) were received, [acked, next) are in flight, some of them received
+	int acked;
+	int next;
+	vector<bool> received;
+	int lastProgress;
+	int timeouts;
+	// partitions of the keyspace carried by the stream
+	vector<int> partitions;
+	OutStream(): id(0), snapshot(0), acked(0), next(0), lastProgress(0), timeouts(0) {}
+	OutStream(int id, Address to, vector<string> chunks, int now): id(id), to(to), chunks(chunks), snapshot(now), acked(0), next(0), received(chunks.size()), lastProgress(now), timeouts(0) {}
+};
+
+/**
+ * CLASS NAME: InStream
+ *
+ * DESCRIPTION: Receiver side of a range transfer: the stream of a sender being applied,
+ * 				the first chunk not received yet and the ones received past it
+ */
+class InStream {
+public:
+	int id;
+	int next;
+	set<int> ahead;
+	InStream(): id(-1), next(0) {}
+};
+
+/**
+ * CLASS NAME: RangeStream
+ *
+ * DESCRIPTION: Codec of the stream chunks.
+ * 				A chunk is a run of records, each made of the length of the prefix shared
+ * 				with the previous key, the rest of the key and the value, lengths being
+ * 				varints. The first record of a chunk shares nothing so every chunk can be
+ * 				decoded on its own.
+ */
+class RangeStream {
+public:
+	static bool fits(const string &key, const string &value, int maxChunkSize);
+	static vector<string> encode(const vector<pair<string, string> > &sorted, int maxChunkSize);
+	static bool decode(const string &chunk, vector<pair<string, string> > &records);
+};
+
+#endif /* RANGESTREAM_H_ */
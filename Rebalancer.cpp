@@ -0,0 +1,212 @@
+/**********************************
+ * FILE NAME: Rebalancer.cpp
+ *
+ * DESCRIPTION: Definition of the load-aware rebalancer
+ **********************************/
+
+#include "Rebalancer.h"
+
+/**
+ * FUNCTION NAME: countRequest
+ *
+ * DESCRIPTION: Count a client request served on partition
+ */
+void Rebalancer::countRequest(int partition) {
+	requests[partition]++;
+}
+
+/**
+ * FUNCTION NAME: report
+ *
+ * DESCRIPTION: Load report of this node: varint total load, varint count and, heaviest
+ * 				first, up to REBALANCE_TOP pairs of varint partition and varint load.
+ * 				Starts counting the requests of the next report.
+ */
+string Rebalancer::report(HashTable *ht) {
+	unsigned long total = 0;
+	vector<pair<unsigned long, int> > partitionLoads;
+	for ( int p = 0; p < PARTITIONS; p++ ) {
+		unsigned long load = ht->partition(p).size() * REBALANCE_KEY_COST + ht->bytes(p) * REBALANCE_BYTE_COST + requests[p] * REBALANCE_REQUEST_COST;
+		requests[p] = 0;
+		if ( load > 0 ) {
+			total += load;
+			partitionLoads.push_back(make_pair(load, p));
+		}
+	}
+	size_t top = min(partitionLoads.size(), (size_t)REBALANCE_TOP);
+	partial_sort(partitionLoads.begin(), partitionLoads.begin() + top, partitionLoads.end(), greater<pair<unsigned long, int> >());
+
+	string payload;
+	putVarint(payload, total);
+	putVarint(payload, top);
+	for ( size_t i = 0; i < top; i++ ) {
+		putVarint(payload, partitionLoads[i].second);
+		putVarint(payload, partitionLoads[i].first);
+	}
+	return payload;
+}
+
+/**
+ * FUNCTION NAME: receiveReport
+ *
+ * DESCRIPTION: Keep the latest load report of a node. Malformed reports are dropped.
+ */
+void Rebalancer::receiveReport(string node, const string &payload, int now) {
+	const char *data = payload.data();
+	int size = payload.size();
+	int pos = 0;
+	NodeLoad nodeLoad;
+	unsigned long count;
+	if ( !getVarint(data, size, pos, nodeLoad.load) || !getVarint(data, size, pos, count) ) {
+		return;
+	}
+	for ( unsigned long i = 0; i < count; i++ ) {
+		unsigned long partition, load;
+		if ( !getVarint(data, size, pos, partition) || !getVarint(data, size, pos, load) || partition >= PARTITIONS ) {
+			return;
+		}
+		nodeLoad.top.push_back(make_pair((int)partition, load));
+	}
+	nodeLoad.reportedAt = now;
+	loads[node] = nodeLoad;
+}
+
+/**
+ * FUNCTION NAME: plan
+ *
+ * DESCRIPTION: Leader side of a rebalancing round.
+ * 				Forgets the moves from or to nodes that left the ring, then, when every
+ * 				node of the ring reported within the last two periods and the hottest one
+ * 				is above the mean by more than REBALANCE_TOLERANCE, hands its heaviest
+ * 				partitions to the coldest node as long as that does not make the coldest
+ * 				node the hotter of the two.
+ *
+ * RETURNS:
+ * true if the moves changed
+ */
+bool Rebalancer::plan(PartitionMap &partitionMap, vector<Node> &ring, int now, int period) {
+	bool changed = false;
+	map<string, Node *> inRing;
+	for ( size_t i = 0; i < ring.size(); i++ ) {
+		inRing[ring[i].nodeAddress.getAddress()] = &ring[i];
+	}
+	map<int, PartitionMove>::iterator it = moves.begin();
+	while ( it != moves.end() ) {
+		if ( !inRing.count(it->second.from.getAddress()) || !inRing.count(it->second.to.getAddress()) ) {
+			moves.erase(it++);
+			changed = true;
+		}
+		else {
+			it++;
+		}
+	}
+
+	string hot, cold;
+	unsigned long sum = 0;
+	map<string, Node *>::iterator node;
+	for ( node = inRing.begin(); node != inRing.end(); node++ ) {
+		map<string, NodeLoad>::iterator search = loads.find(node->first);
+		if ( search == loads.end() || now - search->second.reportedAt > 2 * period ) {
+			return changed;
+		}
+		sum += search->second.load;
+		if ( hot.empty() || search->second.load > loads[hot].load ) {
+			hot = node->first;
+		}
+		if ( cold.empty() || search->second.load < loads[cold].load ) {
+			cold = node->first;
+		}
+	}
+	if ( inRing.size() < 2 ) {
+		return changed;
+	}
+	double mean = (double)sum / inRing.size();
+	unsigned long hotLoad = loads[hot].load;
+	unsigned long coldLoad = loads[cold].load;
+	if ( hotLoad <= mean * (1 + REBALANCE_TOLERANCE) ) {
+		return changed;
+	}
+
+	Address from = inRing[hot]->nodeAddress;
+	Address to = inRing[cold]->nodeAddress;
+	int moved = 0;
+	vector<pair<int, unsigned long> > &top = loads[hot].top;
+	for ( size_t i = 0; i < top.size() && moved < REBALANCE_MOVES; i++ ) {
+		int partition = top[i].first;
+		unsigned long load = top[i].second;
+		if ( load >= hotLoad || coldLoad + load >= hotLoad - load || moves.count(partition) ) {
+			continue;
+		}
+		if ( !partitionMap.isReplica(partition, from) || partitionMap.isReplica(partition, to) ) {
+			continue;
+		}
+		PartitionMove move;
+		move.from = from;
+		move.to = to;
+		moves[partition] = move;
+		hotLoad -= load;
+		coldLoad += load;
+		moved++;
+		changed = true;
+	}
+	if ( moved > 0 ) {
+		// the reports predate the moves
+		loads.erase(hot);
+		loads.erase(cold);
+	}
+	return changed;
+}
+
+/**
+ * FUNCTION NAME: encodeMoves
+ *
+ * DESCRIPTION: varint count, then for every move varint partition, source and destination addresses
+ */
+string Rebalancer::encodeMoves() {
+	string payload;
+	putVarint(payload, moves.size());
+	map<int, PartitionMove>::iterator it;
+	for ( it = moves.begin(); it != moves.end(); it++ ) {
+		putVarint(payload, it->first);
+		payload.append(it->second.from.addr, sizeof(it->second.from.addr));
+		payload.append(it->second.to.addr, sizeof(it->second.to.addr));
+	}
+	return payload;
+}
+
+/**
+ * FUNCTION NAME: applyMoves
+ *
+ * DESCRIPTION: Take the moves sent by the leader, unless a newer version was taken already
+ *
+ * RETURNS:
+ * true if the moves were taken
+ */
+bool Rebalancer::applyMoves(long version, const string &payload) {
+	if ( version <= this->version ) {
+		return false;
+	}
+	const char *data = payload.data();
+	int size = payload.size();
+	int pos = 0;
+	unsigned long count;
+	map<int, PartitionMove> received;
+	if ( !getVarint(data, size, pos, count) ) {
+		return false;
+	}
+	for ( unsigned long i = 0; i < count; i++ ) {
+		unsigned long partition;
+		PartitionMove move;
+		if ( !getVarint(data, size, pos, partition) || partition >= PARTITIONS || size - pos < (int)(2 * sizeof(move.from.addr)) ) {
+			return false;
+		}
+		memcpy(move.from.addr, data + pos, sizeof(move.from.addr));
+		pos += sizeof(move.from.addr);
+		memcpy(move.to.addr, data + pos, sizeof(move.to.addr));
+		pos += sizeof(move.to.addr);
+		received[partition] = move;
+	}
+	this->version = version;
+	moves = received;
+	return true;
+}
@@ -0,0 +1,62 @@
+/**********************************
+ * FILE NAME: Rebalancer.h
+ *
+ * DESCRIPTION: Header file of the load-aware rebalancer of the partitions
+ **********************************/
+
+#ifndef REBALANCER_H_
+#define REBALANCER_H_
+
+/*
+ * Macros
+ */
+// load of a partition: every key, byte and request since the last report costs
+#define REBALANCE_KEY_COST 16
+#define REBALANCE_BYTE_COST 1
+#define REBALANCE_REQUEST_COST 64
+// heaviest partitions of every node reported to the leader
+#define REBALANCE_TOP 8
+// partitions moved per rebalancing round, which throttles the transfers
+#define REBALANCE_MOVES 2
+// a node is hot when its load is above the mean by this fraction
+#define REBALANCE_TOLERANCE 0.2
+
+#include "stdincludes.h"
+#include "Member.h"
+#include "HashTable.h"
+#include "Partitioner.h"
+#include "Varint.h"
+
+/**
+ * CLASS NAME: Rebalancer
+ *
+ * DESCRIPTION: Evens out the load of the nodes by moving partitions from hot to cold nodes.
+ * 				Every REBALANCE ticks each node reports its load (keys, bytes and requests
+ * 				served) and its heaviest partitions to the leader, the first node of the
+ * 				ring. The leader moves up to REBALANCE_MOVES partitions of the hottest node
+ * 				to the coldest one and sends the whole list of moves, versioned, to every
+ * 				node, which then places the partitions with them (see PartitionMap).
+ */
+class Rebalancer {
+private:
+	struct NodeLoad {
+		unsigned long load;
+		vector<pair<int, unsigned long> > top;
+		int reportedAt;
+	};
+	map<string, NodeLoad> loads;
+	vector<unsigned long> requests;
+public:
+	// moves in force and the version they were sent with
+	map<int, PartitionMove> moves;
+	long version;
+	Rebalancer(): requests(PARTITIONS, 0), version(-1) {}
+	void countRequest(int partition);
+	string report(HashTable *ht);
+	void receiveReport(string node, const string &payload, int now);
+	bool plan(PartitionMap &partitionMap, vector<Node> &ring, int now, int period);
+	string encodeMoves();
+	bool applyMoves(long version, const string &payload);
+};
+
+#endif /* REBALANCER_H_ */
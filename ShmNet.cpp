@@ -0,0 +1,305 @@
+/**********************************
+ * FILE NAME: ShmNet.cpp
+ *
+ * DESCRIPTION: Shared memory network classes definition
+ **********************************/
+
+#include "ShmNet.h"
+
+/**
+ * Constructor
+ *
+ * DESCRIPTION: Create the segment of this channel, or attach to it if another
+ * 				process of the deployment already created it. A segment left over by
+ * 				an earlier run is removed and created anew.
+ */
+ShmNet::ShmNet(Params *p, int channel): Transport(p), owner(false), arrived(false), nextid(p->NODE_OFFSET + 1), seg(NULL), hdr(NULL) {
+	int slots = 1;
+	while ( slots < par->SHM_SLOTS ) {
+		slots <<= 1;
+	}
+	int nodes = par->GROUP_SIZE;
+	int slotsize = par->MAX_MSG_SIZE;
+	size_t hdrsize = (sizeof(shm_header) + SHM_CACHELINE - 1) / SHM_CACHELINE * SHM_CACHELINE;
+
+	slotstride = (sizeof(shm_slot) + slotsize + SHM_CACHELINE - 1) / SHM_CACHELINE * SHM_CACHELINE;
+	segsize = hdrsize + (nodes + 1) * sizeof(shm_ring) + (size_t)(nodes + 1) * slots * slotstride;
+	name = string(par->SHM_NAME) + "." + to_string(channel);
+
+	int fd = -1;
+	for ( int attempt = 0; attempt < 2 && fd < 0; attempt++ ) {
+		fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		if ( fd >= 0 || errno != EEXIST ) {
+			break;
+		}
+		if ( attach() != 0 ) {
+			return;
+		}
+		// left over by an earlier run
+		shm_unlink(name.c_str());
+	}
+	if ( fd < 0 ) {
+		return;
+	}
+	if ( ftruncate(fd, segsize) < 0 ) {
+		close(fd);
+		shm_unlink(name.c_str());
+		return;
+	}
+
+	void *addr = mmap(NULL, segsize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if ( addr == MAP_FAILED ) {
+		shm_unlink(name.c_str());
+		return;
+	}
+	owner = true;
+	seg = (char *)addr;
+	hdr = (shm_header *)seg;
+
+	new (&hdr->ready) std::atomic<int>(0);
+	new (&hdr->arrived) std::atomic<int>(0);
+	hdr->creator = getpid();
+	hdr->magic = SHM_MAGIC;
+	hdr->nodes = nodes;
+	hdr->slots = slots;
+	hdr->slotsize = slotsize;
+	for ( int id = 0; id <= nodes; id++ ) {
+		shm_ring *ring = ringOf(id);
+		new (&ring->head) std::atomic<unsigned long>(0);
+		ring->tail = 0;
+		ring->leased = 0;
+		for ( int i = 0; i < slots; i++ ) {
+			new (&slotOf(ring, i)->seq) std::atomic<unsigned long>(i);
+		}
+	}
+	hdr->ready.store(1, std::memory_order_release);
+}
+
+/**
+ * FUNCTION NAME: attach
+ *
+ * DESCRIPTION: Map the segment another process created, once that process set it up.
+ * 				The segment is stale when its creator is gone or never set it up.
+ *
+ * RETURNS:
+ * 1 if attached, 0 if the segment is stale, -1 if it is in use with another geometry
+ * or cannot be mapped
+ */
+int ShmNet::attach() {
+	int fd = shm_open(name.c_str(), O_RDWR, 0600);
+	if ( fd < 0 ) {
+		return errno == ENOENT ? 0 : -1;
+	}
+	// the creator sizes the segment right after creating it
+	struct stat st;
+	for ( int waited = 0; waited < SHM_ATTACH_MS; waited++ ) {
+		if ( fstat(fd, &st) < 0 ) {
+			close(fd);
+			return -1;
+		}
+		if ( (size_t)st.st_size >= sizeof(shm_header) ) {
+			break;
+		}
+		usleep(1000);
+	}
+	if ( (size_t)st.st_size < sizeof(shm_header) ) {
+		close(fd);
+		return 0;
+	}
+	void *addr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if ( addr == MAP_FAILED ) {
+		return -1;
+	}
+	shm_header *header = (shm_header *)addr;
+	for ( int waited = 0; waited < SHM_ATTACH_MS && header->ready.load(std::memory_order_acquire) == 0; waited++ ) {
+		usleep(1000);
+	}
+	bool live = header->ready.load(std::memory_order_acquire) == 1 && header->magic == SHM_MAGIC
+			&& (kill(header->creator, 0) == 0 || errno == EPERM);
+	if ( !live || (size_t)st.st_size != segsize ) {
+		munmap(addr, st.st_size);
+		return live ? -1 : 0;
+	}
+	seg = (char *)addr;
+	hdr = header;
+	return 1;
+}
+
+/**
+ * Destructor
+ */
+ShmNet::~ShmNet() {
+	if ( seg != NULL ) {
+		munmap(seg, segsize);
+	}
+}
+
+/**
+ * FUNCTION NAME: ringOf
+ *
+ * DESCRIPTION: Ring of the node with the given id, NULL if the id has no ring
+ */
+shm_ring *ShmNet::ringOf(int id) {
+	if ( seg == NULL || id < 0 || id > hdr->nodes ) {
+		return NULL;
+	}
+	size_t hdrsize = (sizeof(shm_header) + SHM_CACHELINE - 1) / SHM_CACHELINE * SHM_CACHELINE;
+	return (shm_ring *)(seg + hdrsize) + id;
+}
+
+/**
+ * FUNCTION NAME: slotOf
+ *
+ * DESCRIPTION: Slot used by position pos of a ring
+ */
+shm_slot *ShmNet::slotOf(shm_ring *ring, unsigned long pos) {
+	size_t hdrsize = (sizeof(shm_header) + SHM_CACHELINE - 1) / SHM_CACHELINE * SHM_CACHELINE;
+	char *slots = seg + hdrsize + (hdr->nodes + 1) * sizeof(shm_ring);
+	long id = ring - ringOf(0);
+	return (shm_slot *)(slots + ((size_t)id * hdr->slots + (pos & (hdr->slots - 1))) * slotstride);
+}
+
+/**
+ * FUNCTION NAME: ENinit
+ *
+ * DESCRIPTION: Take the next node id of this process
+ */
+void *ShmNet::ENinit(Address *myaddr, short port) {
+	if ( seg == NULL ) {
+		return NULL;
+	}
+	*(int *)(myaddr->addr) = nextid++;
+	*(short *)(&myaddr->addr[4]) = 0;
+	return myaddr;
+}
+
+/**
+ * FUNCTION NAME: ENsend
+ *
+ * DESCRIPTION: Copy the message into a free slot of the destination ring.
+ * 				The message is lost if the ring is full.
+ *
+ * RETURNS:
+ * size
+ */
+int ShmNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
+	TraceSpan span("ShmNet::ENsend", myaddr);
+	shm_ring *ring = ringOf(*(int *)(toaddr->addr));
+	if ( ring == NULL || size > hdr->slotsize || dropMessage(myaddr, toaddr, size + (int)sizeof(shm_slot)) ) {
+		return 0;
+	}
+
+	unsigned long pos = ring->head.load(std::memory_order_relaxed);
+	shm_slot *slot;
+	while ( true ) {
+		slot = slotOf(ring, pos);
+		long dif = (long)slot->seq.load(std::memory_order_acquire) - (long)pos;
+		if ( dif == 0 ) {
+			if ( ring->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) ) {
+				break;
+			}
+		}
+		else if ( dif < 0 ) {
+			// Ring full
+			return 0;
+		}
+		else {
+			pos = ring->head.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->size = size;
+	memcpy((char *)(slot + 1), data, size);
+	slot->seq.store(pos + 1, std::memory_order_release);
+
+	countSent(myaddr, size);
+	return size;
+}
+
+/**
+ * FUNCTION NAME: release
+ *
+ * DESCRIPTION: Give the slots leased by the previous ENrecv back to the producers
+ */
+void ShmNet::release(shm_ring *ring) {
+	while ( ring->leased > 0 ) {
+		unsigned long pos = ring->tail - ring->leased;
+		slotOf(ring, pos)->seq.store(pos + hdr->slots, std::memory_order_release);
+		ring->leased--;
+	}
+}
+
+/**
+ * FUNCTION NAME: ENrecv
+ *
+ * DESCRIPTION: Enqueue every message published in the ring of this node.
+ * 				The queue receives pointers into the ring, not copies.
+ *
+ * RETURN:
+ * 0
+ */
+int ShmNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue) {
+	TraceSpan span("ShmNet::ENrecv", myaddr);
+	// times is always assumed to be 1
+	shm_ring *ring = ringOf(*(int *)(myaddr->addr));
+	if ( ring == NULL ) {
+		return 0;
+	}
+
+	release(ring);
+
+	while ( true ) {
+		shm_slot *slot = slotOf(ring, ring->tail);
+		if ( slot->seq.load(std::memory_order_acquire) != ring->tail + 1 ) {
+			break;
+		}
+		(*enq)(queue, (char *)(slot + 1), slot->size);
+		ring->tail++;
+		ring->leased++;
+
+		countRecv(myaddr, slot->size);
+	}
+
+	return 0;
+}
+
+/**
+ * FUNCTION NAME: ENrelease
+ *
+ * DESCRIPTION: The buffer is a slot of the ring, the next ENrecv of its node releases it
+ */
+void ShmNet::ENrelease(void *buff) {}
+
+/**
+ * FUNCTION NAME: barrier
+ *
+ * DESCRIPTION: Add the nodes of this process to the count of the segment on the first
+ * 				call, then wait for it to reach GROUP_SIZE
+ */
+bool ShmNet::barrier() {
+	if ( hdr == NULL ) {
+		return true;
+	}
+	if ( !arrived ) {
+		hdr->arrived.fetch_add(par->EN_GPSZ);
+		arrived = true;
+	}
+	return hdr->arrived.load() >= par->GROUP_SIZE;
+}
+
+/**
+ * FUNCTION NAME: ENcleanup
+ *
+ * DESCRIPTION: Cleanup the ShmNet. Called exactly once at the end of the program.
+ * 				The process that created the segment removes its name.
+ */
+int ShmNet::ENcleanup() {
+	if ( owner ) {
+		shm_unlink(name.c_str());
+		owner = false;
+	}
+	writeMsgCount();
+	return 0;
+}
@@ -0,0 +1,107 @@
+/**********************************
+ * FILE NAME: ShmNet.h
+ *
+ * DESCRIPTION: Shared memory network classes header file
+ **********************************/
+
+#ifndef _SHMNET_H_
+#define _SHMNET_H_
+
+/*
+ * Macros
+ */
+#define SHM_MAGIC 0x4b565348
+#define SHM_CACHELINE 64
+// milliseconds a process attaching waits for the creator of the segment to set it up
+#define SHM_ATTACH_MS 1000
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "Member.h"
+#include "Transport.h"
+#include <atomic>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Struct Name: shm_header
+ *
+ * DESCRIPTION: First bytes of the segment, shared by every attached process
+ */
+typedef struct shm_header {
+	unsigned int magic;
+	std::atomic<int> ready;
+	// nodes of the processes that reached the start barrier
+	std::atomic<int> arrived;
+	// process that created the segment, the segment is stale once it is gone
+	pid_t creator;
+	int nodes;
+	int slots;
+	int slotsize;
+} shm_header;
+
+/**
+ * Struct Name: shm_ring
+ *
+ * DESCRIPTION: Bounded MPSC ring of one destination node.
+ * 				Producers claim slots by advancing head, the single consumer (the
+ * 				destination node) advances tail. Every slot carries a sequence number
+ * 				telling producers and the consumer whose turn it is.
+ */
+typedef struct shm_ring {
+	std::atomic<unsigned long> head;
+	char pad1[SHM_CACHELINE - sizeof(std::atomic<unsigned long>)];
+	unsigned long tail;
+	// slots handed out by the last ENrecv, released by the next one
+	unsigned long leased;
+	char pad2[SHM_CACHELINE - 2 * sizeof(unsigned long)];
+} shm_ring;
+
+/**
+ * Struct Name: shm_slot
+ */
+typedef struct shm_slot {
+	std::atomic<unsigned long> seq;
+	int size;
+	// followed by slotsize bytes of payload
+} shm_slot;
+
+/**
+ * CLASS NAME: ShmNet
+ *
+ * DESCRIPTION: Transport backend for nodes living on the same machine.
+ * 				Every destination node owns a ring in a POSIX shared memory segment,
+ * 				senders copy the message straight into a slot of that ring and the
+ * 				receiver never enters the kernel. The segment has a ring for every node
+ * 				of the deployment, and each process takes the ids after its NODE_OFFSET.
+ * 				ENrecv hands out pointers into the ring instead of copies: those buffers
+ * 				stay valid until the next ENrecv of the same node, ENrelease does not free them.
+ */
+class ShmNet : public Transport
+{
+private:
+	string name;
+	bool owner;
+	bool arrived;
+	int nextid;
+	size_t segsize;
+	size_t slotstride;
+	char *seg;
+	shm_header *hdr;
+	shm_ring *ringOf(int id);
+	shm_slot *slotOf(shm_ring *ring, unsigned long pos);
+	void release(shm_ring *ring);
+	int attach();
+public:
+	ShmNet(Params *p, int channel);
+	virtual ~ShmNet();
+	void *ENinit(Address *myaddr, short port);
+	using Transport::ENsend;
+	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
+	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	void ENrelease(void *buff);
+	int ENcleanup();
+	bool barrier();
+};
+
+#endif /* _SHMNET_H_ */
@@ -0,0 +1,73 @@
+/**********************************
+ * FILE NAME: Stats.cpp
+ *
+ * DESCRIPTION: Definition of the latency and throughput statistics of the KV store
+ **********************************/
+
+#include "Stats.h"
+
+/**
+ * constructor
+ */
+Stats::Stats(): windowTick(0), windowStart(now()) {
+	memset(operations, 0, sizeof(operations));
+	memset(failures, 0, sizeof(failures));
+	const char *roles[] = { "coordinator", "server" };
+	const char *types[] = { "create", "read", "update", "delete" };
+	for ( int role = 0; role < 2; role++ ) {
+		for ( int type = 0; type < 4; type++ ) {
+			string labels = string("role=\"") + roles[role] + "\",op=\"" + types[type] + "\"";
+			exported[role][type] = metrics().histogram("kv_operation_latency_seconds", "Latency of the CRUD operations.", labels);
+			outcomes[role][type][0] = metrics().counter("kv_operations_total", "CRUD operations by outcome.", labels + ",result=\"fail\"");
+			outcomes[role][type][1] = metrics().counter("kv_operations_total", "CRUD operations by outcome.", labels + ",result=\"success\"");
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: record
+ *
+ * DESCRIPTION: Count a CRUD operation that took nanos
+ */
+void Stats::record(StatsRole role, MessageType type, bool success, unsigned long nanos) {
+	if ( type > DELETE ) {
+		return;
+	}
+	latency[role][type].record(nanos);
+	exported[role][type]->observe(nanos);
+	outcomes[role][type][success]->add();
+	operations[role][type]++;
+	if ( !success ) {
+		failures[role][type]++;
+	}
+}
+
+/**
+ * FUNCTION NAME: report
+ *
+ * DESCRIPTION: Log the statistics of the window ending at tick and start the next one
+ */
+void Stats::report(Log *log, Address *addr, int tick) {
+	const char *roles[] = { "coordinator", "server" };
+	const char *types[] = { "create", "read", "update", "delete" };
+	unsigned long end = now();
+	int ticks = max(tick - windowTick, 1);
+	double seconds = max((end - windowStart) / 1e9, 1e-9);
+
+	for ( int role = 0; role < 2; role++ ) {
+		for ( int type = 0; type < 4; type++ ) {
+			Histogram &h = latency[role][type];
+			if ( h.count() == 0 ) {
+				continue;
+			}
+			log->LOG(addr, "#STATSLOG# %s %s: ops=%lu fail=%lu rate=%.2f/tick %.0f/s total=%lu p50=%.1fus p99=%.1fus p999=%.1fus max=%.1fus",
+					roles[role], types[type], operations[role][type], failures[role][type],
+					(double)operations[role][type] / ticks, operations[role][type] / seconds, h.count(),
+					h.percentile(50) / 1e3, h.percentile(99) / 1e3, h.percentile(99.9) / 1e3, h.max() / 1e3);
+			operations[role][type] = 0;
+			failures[role][type] = 0;
+		}
+	}
+	windowTick = tick;
+	windowStart = end;
+}
@@ -0,0 +1,51 @@
+/**********************************
+ * FILE NAME: Stats.h
+ *
+ * DESCRIPTION: Header file of the latency and throughput statistics of the KV store
+ **********************************/
+
+#ifndef STATS_H_
+#define STATS_H_
+
+#include "stdincludes.h"
+#include "common.h"
+#include "Histogram.h"
+#include "Log.h"
+#include "Metrics.h"
+#include <chrono>
+
+// side of a CRUD operation a statistic is kept for
+enum StatsRole { COORDINATOR_ROLE, REPLICA_ROLE };
+
+/**
+ * CLASS NAME: Stats
+ *
+ * DESCRIPTION: Latency histograms and throughput counters of the CRUD operations of a node,
+ * 				per operation and role. Coordinator latencies run from the dispatch of a
+ * 				transaction to its outcome (timeouts included), replica latencies cover the
+ * 				server side handler. Latencies are in nanoseconds of the monotonic clock.
+ * 				Every STATS_PERIOD ticks report writes a #STATSLOG# line per operation seen
+ * 				to stats.log: operations and failures since the last report, their rate per
+ * 				tick and per second, and the percentiles since the start. The latencies also
+ * 				go to the kv_operation_latency_seconds histograms of the metrics registry,
+ * 				shared by all the nodes, and the outcomes to the kv_operations_total counters.
+ */
+class Stats {
+private:
+	Histogram latency[2][4];
+	HistogramMetric *exported[2][4];
+	Counter *outcomes[2][4][2];
+	unsigned long operations[2][4];
+	unsigned long failures[2][4];
+	int windowTick;
+	unsigned long windowStart;
+public:
+	Stats();
+	static unsigned long now() {
+		return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	void record(StatsRole role, MessageType type, bool success, unsigned long nanos);
+	void report(Log *log, Address *addr, int tick);
+};
+
+#endif /* STATS_H_ */
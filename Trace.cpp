@@ -16,6 +16,7 @@
  * Header files
  */
 #include "Trace.h"
+#include <set>
 
 /*****************************************************************
  * NAME: traceFileCreate
@@ -132,3 +133,135 @@ int Trace::funcExit(char *funcName, int f_rc) {
 
     return rc;
 }
+
+/*
+ * State of the span tracer
+ */
+atomic<bool> SpanTracer::on(false);
+mutex SpanTracer::lock;
+vector<SpanTracer::Buffer *> SpanTracer::buffers;
+unsigned long SpanTracer::startClock = 0;
+chrono::steady_clock::time_point SpanTracer::startTime;
+
+/*****************************************************************
+ * NAME: start
+ *
+ * DESCRIPTION: Turns span recording on, and notes where the clock
+ *              stands for the conversion of the timestamps
+ *
+ ****************************************************************/
+void SpanTracer::start() {
+
+    lock_guard<mutex> guard(lock);
+    startClock = traceClock();
+    startTime = chrono::steady_clock::now();
+    on.store(true, memory_order_relaxed);
+}
+
+/*****************************************************************
+ * NAME: buffer
+ *
+ * DESCRIPTION: Buffer of the calling thread, registered on first use
+ *
+ ****************************************************************/
+SpanTracer::Buffer *SpanTracer::buffer() {
+
+    static thread_local Buffer *mine = NULL;
+    if ( NULL == mine )
+    {
+        mine = new Buffer();
+        mine->events.reserve(TRACE_BUFFER_SPANS);
+        mine->dropped = 0;
+        lock_guard<mutex> guard(lock);
+        buffers.push_back(mine);
+    }
+    return mine;
+}
+
+/*****************************************************************
+ * NAME: record
+ *
+ * DESCRIPTION: Keeps a closed span in the buffer of the calling
+ *              thread, or counts it as dropped once the buffer is full
+ *
+ ****************************************************************/
+void SpanTracer::record(const char *name, int node, unsigned long start, unsigned long end) {
+
+    Buffer *mine = buffer();
+    if ( mine->events.size() >= TRACE_BUFFER_SPANS )
+    {
+        mine->dropped++;
+        return;
+    }
+    TraceEvent event = { name, node, start, end };
+    mine->events.push_back(event);
+}
+
+/*****************************************************************
+ * NAME: dump
+ *
+ * DESCRIPTION: Stops span recording and writes every span as a
+ *              complete ("X") event of the Chrome trace format, with
+ *              timestamps in microseconds since start. The clock rate
+ *              is measured over the traced run.
+ *
+ * PARAMETERS:
+ *            (const char *) path - file to write
+ *
+ * RETURN:
+ * (bool) true if the file was written
+ *
+ ****************************************************************/
+bool SpanTracer::dump(const char *path) {
+
+    on.store(false, memory_order_relaxed);
+    lock_guard<mutex> guard(lock);
+
+    double elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - startTime).count() / 1e3;
+    unsigned long clocks = traceClock() - startClock;
+    double clocksPerMicro = (elapsed > 0 && clocks > 0) ? clocks / elapsed : 1e3;
+
+    FILE *file = fopen(path, "w");
+    if ( NULL == file )
+    {
+        return false;
+    }
+
+    set<int> nodes;
+    unsigned long dropped = 0;
+    fprintf(file, "{\"traceEvents\":[\n");
+    bool first = true;
+    for ( size_t i = 0; i < buffers.size(); i++ )
+    {
+        vector<TraceEvent> &events = buffers[i]->events;
+        for ( size_t j = 0; j < events.size(); j++ )
+        {
+            fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    first ? "" : ",\n", events[j].name, events[j].node,
+                    (long)(events[j].start - startClock) / clocksPerMicro, (events[j].end - events[j].start) / clocksPerMicro);
+            first = false;
+            nodes.insert(events[j].node);
+        }
+        dropped += buffers[i]->dropped;
+        events.clear();
+        buffers[i]->dropped = 0;
+    }
+    for ( set<int>::iterator it = nodes.begin(); it != nodes.end(); it++ )
+    {
+        char thread[32];
+        if ( TRACE_APPLICATION == *it )
+        {
+            sprintf(thread, "application");
+        }
+        else
+        {
+            sprintf(thread, "node %d", *it);
+        }
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", *it, thread);
+        first = false;
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedSpans\":%lu}}\n", dropped);
+
+    return 0 == fclose(file);
+}
@@ -8,11 +8,22 @@
 #define TRACE_H_
 
 #include "stdincludes.h"
+#include "Member.h"
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 /*
  * Macros
  */
 #define LOG_FILE_LOCATION "machine.log"
+// spans a thread keeps until the trace is dumped, later ones are dropped
+#define TRACE_BUFFER_SPANS 262144
+// trace thread of the spans that belong to no node
+#define TRACE_APPLICATION 0
 
 /**
  * CLASS NAME: Trace
@@ -37,4 +48,77 @@ public:
              );
 };
 
+/**
+ * FUNCTION NAME: traceClock
+ *
+ * DESCRIPTION: Timestamp of a span: the time stamp counter where there is one, otherwise
+ * 				nanoseconds of the monotonic clock. SpanTracer converts it at dump time.
+ */
+inline unsigned long traceClock() {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// a closed span
+struct TraceEvent {
+	const char *name;
+	int node;
+	unsigned long start;
+	unsigned long end;
+};
+
+/**
+ * CLASS NAME: SpanTracer
+ *
+ * DESCRIPTION: Collects the spans of every thread while tracing is on and dumps them in the
+ * 				Chrome trace event format, which chrome://tracing and ui.perfetto.dev open.
+ * 				Every thread appends to a buffer of its own, registered on its first span,
+ * 				so recording takes no lock. In the dump every node is a thread of its own,
+ * 				the spans of the application loop being under TRACE_APPLICATION.
+ */
+class SpanTracer {
+private:
+	struct Buffer {
+		vector<TraceEvent> events;
+		unsigned long dropped;
+	};
+	static atomic<bool> on;
+	static mutex lock;
+	static vector<Buffer *> buffers;
+	static unsigned long startClock;
+	static chrono::steady_clock::time_point startTime;
+	static Buffer *buffer();
+public:
+	static bool enabled() {
+		return on.load(memory_order_relaxed);
+	}
+	static void start();
+	static void record(const char *name, int node, unsigned long start, unsigned long end);
+	static bool dump(const char *path);
+};
+
+/**
+ * CLASS NAME: TraceSpan
+ *
+ * DESCRIPTION: Scoped span, from its construction to the end of its scope. Costs a load
+ * 				and a branch when tracing is off.
+ */
+class TraceSpan {
+private:
+	const char *name;
+	int node;
+	unsigned long start;
+public:
+	TraceSpan(const char *name, int node = TRACE_APPLICATION): name(name), node(node), start(SpanTracer::enabled() ? traceClock() : 0) {}
+	TraceSpan(const char *name, Address *addr): name(name), node(*(int *)addr->addr), start(SpanTracer::enabled() ? traceClock() : 0) {}
+	~TraceSpan() {
+		if ( start ) {
+			SpanTracer::record(name, node, start, traceClock());
+		}
+	}
+};
+
 #endif
@@ -0,0 +1,175 @@
+/**********************************
+ * FILE NAME: Transport.cpp
+ *
+ * DESCRIPTION: Definition of the code shared by all Transport backends
+ **********************************/
+
+#include "Transport.h"
+
+/**
+ * Constructor
+ */
+Transport::Transport(Params *p) {
+	int i, j;
+	par = p;
+	for ( i = 0; i <= MAX_NODES; i++ ) {
+		for ( j = 0; j < MAX_TIME; j++ ) {
+			sent_msgs[i][j] = 0;
+			recv_msgs[i][j] = 0;
+		}
+	}
+	sentMessages = metrics().counter("kv_net_messages_total", "Messages handed to or taken from the network.", "direction=\"sent\"");
+	recvMessages = metrics().counter("kv_net_messages_total", "Messages handed to or taken from the network.", "direction=\"received\"");
+	sentBytes = metrics().counter("kv_net_bytes_total", "Payload bytes handed to or taken from the network.", "direction=\"sent\"");
+	recvBytes = metrics().counter("kv_net_bytes_total", "Payload bytes handed to or taken from the network.", "direction=\"received\"");
+}
+
+/**
+ * Destructor
+ */
+Transport::~Transport() {}
+
+/**
+ * FUNCTION NAME: ENsend
+ *
+ * DESCRIPTION: Send a string message through the backend specific ENsend
+ *
+ * RETURNS:
+ * size
+ */
+int Transport::ENsend(Address *myaddr, Address *toaddr, string data) {
+	char * str = (char *) malloc(data.length() * sizeof(char));
+	memcpy(str, data.c_str(), data.size());
+	int ret = this->ENsend(myaddr, toaddr, str, (data.length() * sizeof(char)));
+	free(str);
+	return ret;
+}
+
+/**
+ * FUNCTION NAME: ENrelease
+ *
+ * DESCRIPTION: Give back a buffer handed out by ENrecv that will not be read.
+ * 				Backends enqueue copies by default, which the caller owns.
+ */
+void Transport::ENrelease(void *buff) {
+	free(buff);
+}
+
+/**
+ * FUNCTION NAME: dropMessage
+ *
+ * DESCRIPTION: Decide if a message of size bytes (headers included) is lost, either because
+ * 				it does not fit in MAX_MSG_SIZE, because of the configured drop probability or
+ * 				because a network partition separates its ends
+ */
+bool Transport::dropMessage(Address *myaddr, Address *toaddr, int size) {
+	int sendmsg = rand() % 100;
+	if ( !sides.empty() && sides[*(int *)(myaddr->addr)] != sides[*(int *)(toaddr->addr)] ) {
+		return true;
+	}
+	return (size >= par->MAX_MSG_SIZE) || (par->dropmsg && sendmsg < (int) (par->MSG_DROP_PROB * 100));
+}
+
+/**
+ * FUNCTION NAME: barrier
+ *
+ * DESCRIPTION: Start barrier of the processes of a deployment, polled until it returns true:
+ * 				the first call tells the other processes that this one arrived, and a call
+ * 				returns whether the GROUP_SIZE nodes of all of them did. A backend that does
+ * 				not span processes has nothing to wait for.
+ */
+bool Transport::barrier() {
+	return true;
+}
+
+/**
+ * FUNCTION NAME: partition
+ *
+ * DESCRIPTION: Cut the nodes with these ids off from the others until heal
+ */
+void Transport::partition(const vector<int> &nodes) {
+	sides.assign(MAX_NODES + 1, 0);
+	for ( size_t i = 0; i < nodes.size(); i++ ) {
+		if ( nodes[i] >= 0 && nodes[i] <= MAX_NODES ) {
+			sides[nodes[i]] = 1;
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: heal
+ */
+void Transport::heal() {
+	sides.clear();
+}
+
+/**
+ * FUNCTION NAME: countSent
+ *
+ * DESCRIPTION: Account one sent message of size bytes for the node at myaddr
+ */
+void Transport::countSent(Address *myaddr, int size) {
+	int src = *(int *)(myaddr->addr);
+	int time = par->getcurrtime();
+
+	assert(src <= MAX_NODES);
+	assert(time < MAX_TIME);
+
+	sent_msgs[src][time]++;
+	sentMessages->add();
+	sentBytes->add(size);
+}
+
+/**
+ * FUNCTION NAME: countRecv
+ *
+ * DESCRIPTION: Account one received message of size bytes for the node at myaddr
+ */
+void Transport::countRecv(Address *myaddr, int size) {
+	int dst = *(int *)(myaddr->addr);
+	int time = par->getcurrtime();
+
+	assert(dst <= MAX_NODES);
+	assert(time < MAX_TIME);
+
+	recv_msgs[dst][time]++;
+	recvMessages->add();
+	recvBytes->add(size);
+}
+
+/**
+ * FUNCTION NAME: writeMsgCount
+ *
+ * DESCRIPTION: Dump the message counters to msgcount.log
+ */
+void Transport::writeMsgCount() {
+	int i, j;
+	int sent_total, recv_total;
+
+	FILE* file = fopen("msgcount.log", "w+");
+
+	for ( i = par->NODE_OFFSET + 1; i <= par->NODE_OFFSET + par->EN_GPSZ; i++ ) {
+		fprintf(file, "node %3d ", i);
+		sent_total = 0;
+		recv_total = 0;
+
+		for (j = 0; j < par->getcurrtime(); j++) {
+
+			sent_total += sent_msgs[i][j];
+			recv_total += recv_msgs[i][j];
+			if (i != 67) {
+				fprintf(file, " (%4d, %4d)", sent_msgs[i][j], recv_msgs[i][j]);
+				if (j % 10 == 9) {
+					fprintf(file, "\n         ");
+				}
+			}
+			else {
+				fprintf(file, "special %4d %4d %4d\n", j, sent_msgs[i][j], recv_msgs[i][j]);
+			}
+		}
+		fprintf(file, "\n");
+		fprintf(file, "node %3d sent_total %6u  recv_total %6u\n\n", i, sent_total, recv_total);
+	}
+
+	fclose(file);
+}
@@ -0,0 +1,72 @@
+/**********************************
+ * FILE NAME: Transport.h
+ *
+ * DESCRIPTION: Header file of the Transport interface implemented by every network backend
+ **********************************/
+
+#ifndef _TRANSPORT_H_
+#define _TRANSPORT_H_
+
+#ifdef STOCK_HARNESS
+
+/*
+ * Built into the assignment harness by run.sh: the nodes talk to its EmulNet directly.
+ */
+#include "EmulNet.h"
+
+typedef EmulNet Transport;
+
+#else
+
+#define MAX_NODES 1000
+#define MAX_TIME 3600
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "Member.h"
+#include "Metrics.h"
+#include "Trace.h"
+
+/**
+ * CLASS NAME: Transport
+ *
+ * DESCRIPTION: Interface between the protocol layers (MP1Node, MP2Node) and the network.
+ * 				EmulNet is the in-process emulated implementation, other backends
+ * 				move real bytes between processes.
+ * 				The per node and per time unit message counters that end up in
+ * 				msgcount.log are kept here so that every backend reports them the same way,
+ * 				along with the message and byte counters of the metrics registry.
+ */
+class Transport
+{
+protected:
+	Params* par;
+	int sent_msgs[MAX_NODES + 1][MAX_TIME];
+	int recv_msgs[MAX_NODES + 1][MAX_TIME];
+	Counter *sentMessages;
+	Counter *sentBytes;
+	Counter *recvMessages;
+	Counter *recvBytes;
+	// side of the network partition of every node id, empty when the network is whole
+	vector<int> sides;
+	bool dropMessage(Address *myaddr, Address *toaddr, int size);
+	void countSent(Address *myaddr, int size);
+	void countRecv(Address *myaddr, int size);
+	void writeMsgCount();
+public:
+	Transport(Params *p);
+	virtual ~Transport();
+	virtual void *ENinit(Address *myaddr, short port) = 0;
+	int ENsend(Address *myaddr, Address *toaddr, string data);
+	virtual int ENsend(Address *myaddr, Address *toaddr, char *data, int size) = 0;
+	virtual int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue) = 0;
+	virtual void ENrelease(void *buff);
+	virtual int ENcleanup() = 0;
+	virtual bool barrier();
+	void partition(const vector<int> &nodes);
+	void heal();
+};
+
+#endif /* STOCK_HARNESS */
+
+#endif /* _TRANSPORT_H_ */
@@ -0,0 +1,231 @@
+/**********************************
+ * FILE NAME: UdpNet.cpp
+ *
+ * DESCRIPTION: UDP network classes definition
+ **********************************/
+
+#include "UdpNet.h"
+
+/**
+ * Constructor
+ */
+UdpNet::UdpNet(Params *p, int channel): Transport(p), channel(channel), nextid(p->NODE_OFFSET + 1), barrierSocket(-1), arrivedNodes(0) {
+	io = IoLoop::create(par->UDP_IO == URING_IO, par->EN_GPSZ);
+}
+
+/**
+ * Destructor
+ */
+UdpNet::~UdpNet() {
+	delete io;
+	for ( map<int, int>::iterator it = sockets.begin(); it != sockets.end(); it++ ) {
+		close(it->second);
+	}
+	if ( barrierSocket >= 0 ) {
+		close(barrierSocket);
+	}
+}
+
+/**
+ * FUNCTION NAME: ENinit
+ *
+ * DESCRIPTION: Assign the next node id of this process and bind the socket of this node
+ */
+void *UdpNet::ENinit(Address *myaddr, short port) {
+	*(int *)(myaddr->addr) = nextid++;
+	*(short *)(&myaddr->addr[4]) = 0;
+	if ( socketOf(myaddr) < 0 ) {
+		return NULL;
+	}
+	return myaddr;
+}
+
+/**
+ * FUNCTION NAME: sockAddrOf
+ *
+ * DESCRIPTION: Map a node address to the UDP endpoint of this channel
+ */
+struct sockaddr_in UdpNet::sockAddrOf(Address *addr) {
+	struct sockaddr_in sa;
+	int id = *(int *)(addr->addr);
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sin_family = AF_INET;
+	sa.sin_port = htons(par->UDP_BASE_PORT + channel * MAX_NODES + id);
+	inet_pton(AF_INET, par->UDP_HOST, &sa.sin_addr);
+	return sa;
+}
+
+/**
+ * FUNCTION NAME: socketOf
+ *
+ * DESCRIPTION: Return the socket owned by the node at addr, binding it on first use
+ *
+ * RETURNS:
+ * file descriptor, -1 on failure
+ */
+int UdpNet::socketOf(Address *addr) {
+	int id = *(int *)(addr->addr);
+	map<int, int>::iterator search = sockets.find(id);
+	if ( search != sockets.end() ) {
+		return search->second;
+	}
+
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if ( fd < 0 ) {
+		return -1;
+	}
+	int bufsize = UDP_SOCKBUFSIZE;
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+	setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufsize, sizeof(bufsize));
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	struct sockaddr_in sa = sockAddrOf(addr);
+	if ( bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0 ) {
+		close(fd);
+		return -1;
+	}
+	io->addSocket(fd);
+	sockets[id] = fd;
+	return fd;
+}
+
+/**
+ * FUNCTION NAME: ENsend
+ *
+ * DESCRIPTION: Queue a datagram on the socket of the sender.
+ * 				Queued datagrams are handed to the kernel in batches by the IoLoop.
+ *
+ * RETURNS:
+ * size
+ */
+int UdpNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
+	TraceSpan span("UdpNet::ENsend", myaddr);
+	if ( dropMessage(myaddr, toaddr, size) ) {
+		return 0;
+	}
+
+	int fd = socketOf(myaddr);
+	if ( fd < 0 ) {
+		return 0;
+	}
+
+	struct sockaddr_in to = sockAddrOf(toaddr);
+	io->send(fd, &to, data, size);
+
+	countSent(myaddr, size);
+	return size;
+}
+
+/**
+ * FUNCTION NAME: countedEnqueue
+ *
+ * DESCRIPTION: Count a datagram received by a node, then enqueue it as the caller of ENrecv asked
+ */
+int UdpNet::countedEnqueue(void *env, char *buff, int size) {
+	CountedQueue *counted = (CountedQueue *)env;
+	counted->net->countRecv(counted->addr, size);
+	return counted->enq(counted->queue, buff, size);
+}
+
+/**
+ * FUNCTION NAME: ENrecv
+ *
+ * DESCRIPTION: Flush the pending sends and enqueue every datagram received by this node
+ *
+ * RETURN:
+ * 0
+ */
+int UdpNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue) {
+	TraceSpan span("UdpNet::ENrecv", myaddr);
+	// times is always assumed to be 1
+	int fd = socketOf(myaddr);
+	if ( fd < 0 ) {
+		return 0;
+	}
+
+	io->poll();
+	CountedQueue counted = { this, myaddr, enq, queue };
+	io->recv(fd, countedEnqueue, &counted);
+
+	return 0;
+}
+
+/**
+ * FUNCTION NAME: barrierAddr
+ */
+struct sockaddr_in UdpNet::barrierAddr() {
+	struct sockaddr_in sa;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sin_family = AF_INET;
+	sa.sin_port = htons(par->UDP_BASE_PORT + 2 * MAX_NODES + 1);
+	inet_pton(AF_INET, par->UDP_HOST, &sa.sin_addr);
+	return sa;
+}
+
+/**
+ * FUNCTION NAME: barrier
+ *
+ * DESCRIPTION: Every other process sends its node count to the process with NODE_OFFSET 0
+ * 				at each call, until that one answers. It answers them all once the counts
+ * 				add up to GROUP_SIZE.
+ */
+bool UdpNet::barrier() {
+	bool holder = (par->NODE_OFFSET == 0);
+	struct sockaddr_in sa = barrierAddr();
+	if ( barrierSocket < 0 ) {
+		barrierSocket = socket(AF_INET, SOCK_DGRAM, 0);
+		if ( barrierSocket < 0 ) {
+			return true;
+		}
+		fcntl(barrierSocket, F_SETFL, fcntl(barrierSocket, F_GETFL) | O_NONBLOCK);
+		if ( holder && bind(barrierSocket, (struct sockaddr *)&sa, sizeof(sa)) < 0 ) {
+			close(barrierSocket);
+			barrierSocket = -1;
+			return true;
+		}
+		arrivedNodes = par->EN_GPSZ;
+	}
+
+	int nodes;
+	struct sockaddr_in from;
+	socklen_t fromlen = sizeof(from);
+	while ( recvfrom(barrierSocket, &nodes, sizeof(nodes), 0, (struct sockaddr *)&from, &fromlen) == sizeof(nodes) ) {
+		if ( !holder ) {
+			return true;
+		}
+		bool known = false;
+		for ( size_t i = 0; i < arrivals.size() && !known; i++ ) {
+			known = arrivals[i].sin_addr.s_addr == from.sin_addr.s_addr && arrivals[i].sin_port == from.sin_port;
+		}
+		if ( !known ) {
+			arrivals.push_back(from);
+			arrivedNodes += nodes;
+		}
+		fromlen = sizeof(from);
+	}
+	if ( !holder ) {
+		nodes = par->EN_GPSZ;
+		sendto(barrierSocket, &nodes, sizeof(nodes), 0, (struct sockaddr *)&sa, sizeof(sa));
+		return false;
+	}
+	if ( arrivedNodes < par->GROUP_SIZE ) {
+		return false;
+	}
+	for ( size_t i = 0; i < arrivals.size(); i++ ) {
+		sendto(barrierSocket, &arrivedNodes, sizeof(arrivedNodes), 0, (struct sockaddr *)&arrivals[i], sizeof(arrivals[i]));
+	}
+	return true;
+}
+
+/**
+ * FUNCTION NAME: ENcleanup
+ *
+ * DESCRIPTION: Cleanup the UdpNet. Called exactly once at the end of the program.
+ */
+int UdpNet::ENcleanup() {
+	io->flush();
+	writeMsgCount();
+	return 0;
+}
@@ -0,0 +1,71 @@
+/**********************************
+ * FILE NAME: UdpNet.h
+ *
+ * DESCRIPTION: UDP network classes header file
+ **********************************/
+
+#ifndef _UDPNET_H_
+#define _UDPNET_H_
+
+/*
+ * Macros
+ */
+#define UDP_SOCKBUFSIZE (4 * 1024 * 1024)
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "Member.h"
+#include "Transport.h"
+#include "IoLoop.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/**
+ * CLASS NAME: UdpNet
+ *
+ * DESCRIPTION: Transport backend sending every message as one UDP datagram.
+ * 				A node with id N on channel C owns a non-blocking socket bound to
+ * 				UDP_HOST:UDP_BASE_PORT + C*MAX_NODES + N, so nodes may live in the same
+ * 				process or in separate processes, each running the ids after its NODE_OFFSET.
+ * 				The sockets are driven by an IoLoop: io_uring when UDP_IO is URING and
+ * 				the kernel supports it, epoll with sendmmsg/recvmmsg batching otherwise.
+ * 				The process with NODE_OFFSET 0 holds the start barrier of the deployment
+ * 				on UDP_BASE_PORT + 2*MAX_NODES + 1, past the ports of the nodes.
+ */
+class UdpNet : public Transport
+{
+private:
+	int channel;
+	int nextid;
+	IoLoop *io;
+	// node id -> bound socket
+	map<int, int> sockets;
+	// start barrier: its socket, and at the process holding it the nodes and
+	// endpoints of the processes arrived so far
+	int barrierSocket;
+	int arrivedNodes;
+	vector<struct sockaddr_in> arrivals;
+	struct sockaddr_in barrierAddr();
+	// what ENrecv hands to the event loop, so every datagram is counted as it is enqueued
+	struct CountedQueue {
+		UdpNet *net;
+		Address *addr;
+		int (* enq)(void *, char *, int);
+		void *queue;
+	};
+	static int countedEnqueue(void *env, char *buff, int size);
+	int socketOf(Address *addr);
+	struct sockaddr_in sockAddrOf(Address *addr);
+public:
+	UdpNet(Params *p, int channel);
+	virtual ~UdpNet();
+	void *ENinit(Address *myaddr, short port);
+	using Transport::ENsend;
+	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
+	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	int ENcleanup();
+	bool barrier();
+};
+
+#endif /* _UDPNET_H_ */
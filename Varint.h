@@ -0,0 +1,61 @@
+/**********************************
+ * FILE NAME: Varint.h
+ *
+ * DESCRIPTION: LEB128 variable length integers used by the binary encodings
+ **********************************/
+
+#ifndef VARINT_H_
+#define VARINT_H_
+
+#include "stdincludes.h"
+
+/**
+ * FUNCTION NAME: putVarint
+ *
+ * DESCRIPTION: Append v to out, 7 bits per byte, low bits first
+ */
+inline void putVarint(string &out, unsigned long v) {
+	while ( v >= 0x80 ) {
+		out.push_back((char)(v | 0x80));
+		v >>= 7;
+	}
+	out.push_back((char)v);
+}
+
+/**
+ * FUNCTION NAME: getVarint
+ *
+ * DESCRIPTION: Read a varint at pos and move pos past it
+ *
+ * RETURNS:
+ * false if the buffer ends in the middle of the varint
+ */
+inline bool getVarint(const char *data, int size, int &pos, unsigned long &v) {
+	v = 0;
+	for ( int shift = 0; pos < size && shift < 64; shift += 7 ) {
+		unsigned char b = data[pos++];
+		v |= (unsigned long)(b & 0x7f) << shift;
+		if ( !(b & 0x80) ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * FUNCTION NAME: zigzag
+ *
+ * DESCRIPTION: Map signed to unsigned so values close to 0 get short varints
+ */
+inline unsigned long zigzag(long v) {
+	return ((unsigned long)v << 1) ^ (unsigned long)(v >> 63);
+}
+
+/**
+ * FUNCTION NAME: unzigzag
+ */
+inline long unzigzag(unsigned long v) {
+	return (long)(v >> 1) ^ -(long)(v & 1);
+}
+
+#endif /* VARINT_H_ */
@@ -0,0 +1,204 @@
+/**********************************
+ * FILE NAME: Workload.cpp
+ *
+ * DESCRIPTION: Definition of the YCSB-style workload driven by the Application layer
+ **********************************/
+
+#include "Workload.h"
+#include "Hash.h"
+
+// proportions of reads, updates, inserts, scans and read-modify-writes of the core workloads
+static const double presetProportions[CUSTOM_WORKLOAD][WORKLOAD_OPS] = {
+	{ 0, 0, 0, 0, 0 },
+	{ 0.5, 0.5, 0, 0, 0 },		// A: update heavy
+	{ 0.95, 0.05, 0, 0, 0 },	// B: read mostly
+	{ 1, 0, 0, 0, 0 },			// C: read only
+	{ 0.95, 0, 0.05, 0, 0 },	// D: read latest
+	{ 0, 0, 0.05, 0.95, 0 },	// E: short ranges
+	{ 0.5, 0, 0, 0, 0.5 }		// F: read-modify-write
+};
+
+/**
+ * constructor
+ */
+ZipfianGenerator::ZipfianGenerator(long items, double theta): theta(theta), alpha(1 / (1 - theta)), zeta2(1 + pow(0.5, theta)), zetan(0), eta(0), items(0) {
+	extend(max(items, 1L));
+}
+
+/**
+ * FUNCTION NAME: extend
+ *
+ * DESCRIPTION: Add the items up to count to the zeta constant
+ */
+void ZipfianGenerator::extend(long count) {
+	for ( long i = items; i < count; i++ ) {
+		zetan += 1 / pow(i + 1, theta);
+	}
+	items = count;
+	eta = (1 - pow(2.0 / items, 1 - theta)) / (1 - zeta2 / zetan);
+}
+
+/**
+ * FUNCTION NAME: next
+ *
+ * DESCRIPTION: Draw a rank among count items
+ */
+long ZipfianGenerator::next(mt19937_64 &rng, long count) {
+	if ( count > items ) {
+		extend(count);
+	}
+	double u = uniform_real_distribution<double>(0, 1)(rng);
+	double uz = u * zetan;
+	if ( uz < 1 ) {
+		return 0;
+	}
+	if ( uz < 1 + pow(0.5, theta) ) {
+		return 1;
+	}
+	long rank = (long)(count * pow(eta * u - eta + 1, alpha));
+	return min(rank, count - 1);
+}
+
+/**
+ * constructor
+ */
+Workload::Workload(Params *par, unsigned long seed): par(par), rng(seed),
+		keys(par->WORKLOAD_RECORDS, par->WORKLOAD_ZIPF),
+		sizes(1, par->WORKLOAD_ZIPF),
+		records(0), operations(0) {
+	double configured[WORKLOAD_OPS] = { par->WORKLOAD_READ, par->WORKLOAD_UPDATE, par->WORKLOAD_INSERT, par->WORKLOAD_SCAN, par->WORKLOAD_RMW };
+	double sum = 0;
+	for ( int i = 0; i < WORKLOAD_OPS; i++ ) {
+		proportions[i] = configured[i] >= 0 ? configured[i] : presetProportions[par->WORKLOAD % CUSTOM_WORKLOAD][i];
+		sum += proportions[i];
+		issued[i] = 0;
+	}
+	// cumulative, reads only when nothing is configured
+	for ( int i = 0; i < WORKLOAD_OPS; i++ ) {
+		proportions[i] = sum > 0 ? proportions[i] / sum : 1;
+		if ( i > 0 ) {
+			proportions[i] += proportions[i - 1];
+		}
+	}
+	distribution = par->WORKLOAD_DISTRIBUTION;
+	if ( distribution < 0 ) {
+		distribution = par->WORKLOAD == WORKLOAD_D ? LATEST_DISTRIBUTION : ZIPFIAN_DISTRIBUTION;
+	}
+	// letters only, so a value never holds the message delimiter
+	for ( int i = 0; i < WORKLOAD_VALUE_POOL + WORKLOAD_MAX_VALUE_SIZE; i++ ) {
+		valuePool.push_back('a' + rng() % 26);
+	}
+}
+
+/**
+ * FUNCTION NAME: name
+ */
+const char *Workload::name() {
+	const char *names[] = { "none", "A", "B", "C", "D", "E", "F", "custom" };
+	return names[par->WORKLOAD];
+}
+
+/**
+ * FUNCTION NAME: keyOf
+ *
+ * DESCRIPTION: Key of a record, hashed so that consecutive records spread over the ring
+ */
+string Workload::keyOf(long record) {
+	return WORKLOAD_KEY_PREFIX + to_string(hash64(&record, sizeof(record)));
+}
+
+/**
+ * FUNCTION NAME: finished
+ *
+ * DESCRIPTION: Whether both phases issued all their operations
+ */
+bool Workload::finished() {
+	return records >= par->WORKLOAD_RECORDS && operations >= par->WORKLOAD_OPERATIONS;
+}
+
+/**
+ * FUNCTION NAME: chooseRecord
+ *
+ * DESCRIPTION: Record of a read, update or scan, among the ones inserted
+ */
+long Workload::chooseRecord() {
+	switch ( distribution ) {
+		case UNIFORM_DISTRIBUTION:
+			return rng() % records;
+		case LATEST_DISTRIBUTION:
+			return records - 1 - keys.next(rng, records);
+		default: {
+			// scrambled, so the popular records are not neighbours
+			unsigned long rank = keys.next(rng, records);
+			return hash64(&rank, sizeof(rank)) % records;
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: makeValue
+ */
+string Workload::makeValue() {
+	int low = max(min(par->WORKLOAD_VALUE_MIN, WORKLOAD_MAX_VALUE_SIZE), 1);
+	int high = max(min(par->WORKLOAD_VALUE_MAX, WORKLOAD_MAX_VALUE_SIZE), low);
+	int size = high;
+	if ( par->WORKLOAD_VALUE_DISTRIBUTION == UNIFORM_DISTRIBUTION ) {
+		size = low + rng() % (high - low + 1);
+	}
+	else if ( par->WORKLOAD_VALUE_DISTRIBUTION == ZIPFIAN_DISTRIBUTION ) {
+		size = low + sizes.next(rng, high - low + 1);
+	}
+	return valuePool.substr(rng() % WORKLOAD_VALUE_POOL, size);
+}
+
+/**
+ * FUNCTION NAME: nextTick
+ *
+ * DESCRIPTION: The up to WORKLOAD_RATE operations of the next tick: the inserts of the load
+ * 				phase first, then the ones of the run phase
+ */
+void Workload::nextTick(vector<WorkloadOp> &ops) {
+	ops.clear();
+	for ( int i = 0; i < par->WORKLOAD_RATE && !finished(); i++ ) {
+		WorkloadOp op;
+		op.length = 1;
+		if ( records < par->WORKLOAD_RECORDS ) {
+			op.type = INSERT_OP;
+		}
+		else {
+			double p = uniform_real_distribution<double>(0, 1)(rng);
+			int type = 0;
+			while ( type < WORKLOAD_OPS - 1 && p >= proportions[type] ) {
+				type++;
+			}
+			// nothing to read before the first insert
+			op.type = records == 0 ? INSERT_OP : (workloadOP)type;
+			issued[op.type]++;
+			operations++;
+		}
+
+		if ( op.type == INSERT_OP ) {
+			op.record = records++;
+		}
+		else {
+			op.record = chooseRecord();
+		}
+		if ( op.type == SCAN_OP ) {
+			op.length = 1 + rng() % max(par->WORKLOAD_SCAN_LENGTH, 1);
+			op.length = min((long)op.length, records - op.record);
+		}
+		if ( op.type == INSERT_OP || op.type == UPDATE_OP || op.type == RMW_OP ) {
+			op.value = makeValue();
+		}
+		ops.push_back(op);
+	}
+}
+
+/**
+ * FUNCTION NAME: summary
+ */
+void Workload::summary(ostream &out) {
+	out<<"Workload "<<name()<<": loaded "<<par->WORKLOAD_RECORDS<<" records, issued "<<operations<<" operations: "
+	   <<issued[READ_OP]<<" reads, "<<issued[UPDATE_OP]<<" updates, "<<issued[INSERT_OP]<<" inserts, "
+	   <<issued[SCAN_OP]<<" scans, "<<issued[RMW_OP]<<" read-modify-writes"<<endl;
+}
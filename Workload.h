@@ -0,0 +1,97 @@
+/**********************************
+ * FILE NAME: Workload.h
+ *
+ * DESCRIPTION: Header file of the YCSB-style workload driven by the Application layer
+ **********************************/
+
+#ifndef WORKLOAD_H_
+#define WORKLOAD_H_
+
+/*
+ * Macros
+ */
+// operations of the run phase, in the order of the proportions
+#define WORKLOAD_OPS 5
+// random letters the values are cut from
+#define WORKLOAD_VALUE_POOL 65536
+// largest value, so that a CREATE or UPDATE message fits in MAX_MSG_SIZE
+#define WORKLOAD_MAX_VALUE_SIZE 2000
+// prefix of the keys, followed by the hashed record number
+#define WORKLOAD_KEY_PREFIX "user"
+
+#include "stdincludes.h"
+#include "Params.h"
+#include <random>
+
+enum workloadOP { READ_OP, UPDATE_OP, INSERT_OP, SCAN_OP, RMW_OP };
+
+/**
+ * STRUCT NAME: WorkloadOp
+ *
+ * DESCRIPTION: One client operation on record number record. A scan reads length records
+ * 				from record on, a read-modify-write reads record then updates it with value.
+ */
+struct WorkloadOp {
+	workloadOP type;
+	long record;
+	int length;
+	string value;
+};
+
+/**
+ * CLASS NAME: ZipfianGenerator
+ *
+ * DESCRIPTION: Ranks 0 to items-1 drawn with the zipfian constant theta, rank 0 being the
+ * 				most popular (Gray et al., "Quickly generating billion-record synthetic
+ * 				databases", as in YCSB). The zeta constant is extended incrementally when
+ * 				the number of items grows.
+ */
+class ZipfianGenerator {
+private:
+	double theta;
+	double alpha;
+	double zeta2;
+	double zetan;
+	double eta;
+	long items;
+	void extend(long count);
+public:
+	ZipfianGenerator(long items, double theta);
+	long next(mt19937_64 &rng, long count);
+};
+
+/**
+ * CLASS NAME: Workload
+ *
+ * DESCRIPTION: Client operations of a YCSB core workload (A to F, or custom proportions).
+ * 				The load phase inserts WORKLOAD_RECORDS records, then the run phase issues
+ * 				WORKLOAD_OPERATIONS reads, updates, inserts, scans and read-modify-writes in
+ * 				the configured proportions, both at WORKLOAD_RATE operations per tick. The
+ * 				records are picked with a zipfian (scrambled over the key space), uniform or
+ * 				latest distribution, and the value sizes are fixed, uniform or zipfian.
+ */
+class Workload {
+private:
+	Params *par;
+	mt19937_64 rng;
+	double proportions[WORKLOAD_OPS];
+	int distribution;
+	ZipfianGenerator keys;
+	ZipfianGenerator sizes;
+	string valuePool;
+	// records inserted so far and run phase operations issued
+	long records;
+	long operations;
+	long issued[WORKLOAD_OPS];
+	long chooseRecord();
+	string makeValue();
+public:
+	Workload(Params *par, unsigned long seed);
+	const char *name();
+	static string keyOf(long record);
+	bool finished();
+	void nextTick(vector<WorkloadOp> &ops);
+	void summary(ostream &out);
+};
+
+#endif /* WORKLOAD_H_ */
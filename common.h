@@ -5,11 +5,20 @@
  * Global variable
  */
 // Transaction Id
-static int g_transID = 0;
+extern int g_transID;
 
 // message types, reply is the message from node to coordinator
-enum MessageType {CREATE, READ, UPDATE, DELETE, REPLY, READREPLY, STABILIZATION};
+enum MessageType {CREATE, READ, UPDATE, DELETE, REPLY, READREPLY, STABILIZATION, STREAMDATA, STREAMACK, LOADREPORT, REBALANCE, REJOIN};
 // enum of replica types
 enum ReplicaType {PRIMARY, SECONDARY, TERTIARY};
 
+// membership protocols of MP1Node and key placements of MP2Node, kept here rather than
+// in Params.h so that the nodes also build against the Params of the assignment harness
+enum membershipTYPE { GOSSIP_MEMBERSHIP, SWIM_MEMBERSHIP };
+
+enum partitionerTYPE { RING_PARTITIONER, JUMP_PARTITIONER, RENDEZVOUS_PARTITIONER };
+
+// fixed partitions of the keyspace, the unit of data placement and movement
+#define PARTITIONS 4096
+
 #endif
@@ -15,13 +15,17 @@ cd grade-dir
 wget https://spark-public.s3.amazonaws.com/cloudcomputing2/assignments/mp2_assignment.zip || { echo 'ERROR ... Please install wget' ; exit 1; }
 unzip mp2_assignment.zip || { echo 'ERROR ... Zip file not found' ; exit 1; }
 cd mp2_assignment
+# Graded against the Application, EmulNet, Log and Params of the assignment: only the
+# nodes and the modules they depend on are copied over, built with STOCK_HARNESS so
+# that they talk to EmulNet directly and use none of the options of this tree's Params
 rm -rf Message.cpp Message.h common.h
-cp ../../MP2Node.* .
-cp ../../MP1Node.* .
-cp ../../Message.* .
-cp ../../common.h .
-make clean > /dev/null 2>&1
-make > /dev/null 2>&1
+for f in MP1Node MP2Node Message Member Node HashTable Entry Trace FailureDetector Metrics \
+		MessageBatch RangeStream Partitioner Rebalancer Stats Histogram ClientTrace; do
+	cp ../../$f.cpp ../../$f.h .
+done
+cp ../../common.h ../../Hash.h ../../Varint.h ../../Transport.h .
+# the Makefile of the assignment only links its own objects
+g++ -o Application *.cpp -Wall -g -std=c++11 -pthread -DSTOCK_HARNESS > /dev/null 2>&1
 
 echo "CREATE test"
 ./Application testcases/create.conf > /dev/null 2>&1